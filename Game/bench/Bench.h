@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Core.h"
+
+// Benchmarks print one CSV row per measurement so runs can be diffed or
+// loaded by scripts. Time is the best of all repeats, per operation.
+//
+// suite,op,count,load,ns_per_op,probe_avg,probe_max
+//
+// count is the number of elements each op ran over, load is the hash table
+// fill at the end of inserting (0 for containers without a load factor).
+// probe_avg/max are slots from each key's home slot after inserting, empty
+// when the suite doesn't measure them.
+
+enum BenchOp : int
+{
+	BENCH_OP_INSERT,
+	BENCH_OP_LOOKUP_HIT,
+	BENCH_OP_LOOKUP_MISS,
+	BENCH_OP_ITERATE,
+	BENCH_OP_ERASE,
+	BENCH_OP_HASH,
+
+	BENCH_OP_COUNT
+};
+
+constant_var const char* BENCH_OP_NAMES[BENCH_OP_COUNT] =
+{
+	"insert",
+	"lookup_hit",
+	"lookup_miss",
+	"iterate",
+	"erase",
+	"hash",
+};
+
+// Seconds per op, ops not supported by a container stay negative
+struct BenchTimings
+{
+	double Seconds[BENCH_OP_COUNT];
+	u32 Count;
+	float Load;
+	float ProbeAvg;
+	u32 ProbeMax;
+	bool HasProbes;
+};
+
+struct BenchContext
+{
+	const char* Filter; // Suites not containing this are skipped, null runs everything
+	int Repeats;
+	u64 Sink; // Results are folded in so the compiler can't drop the work
+};
+
+// size is the element count, or the table capacity for hash containers which
+// are then filled to load
+typedef void(*BenchRunFunc)(BenchContext* ctx, u32 size, float load, BenchTimings* outTimings);
+
+_FORCE_INLINE_ double
+BenchNow()
+{
+	return zpl_time_rel();
+}
+
+bool BenchShouldRun(BenchContext* ctx, const char* suite);
+
+// Runs fn ctx->Repeats times and reports each op's best time
+void BenchRun(BenchContext* ctx, const char* suite, BenchRunFunc fn, u32 size, float load);
+
+void BenchStructures(BenchContext* ctx);
+void BenchHashing(BenchContext* ctx);
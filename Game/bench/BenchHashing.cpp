@@ -0,0 +1,167 @@
+#include "Bench.h"
+
+#include "Structures/HashMapT.h"
+
+// Compares HashTraits' mix against hashing the same key as bytes with wyhash,
+// which is what every key type used before HashTraits. Both go through the
+// same HashMapT so probe lengths show the quality of each hash for the key
+// patterns the game uses.
+
+// Same bytes as T but no HashTraits specialization, falls back to wyhash()
+template<typename T>
+struct BenchBytesKey
+{
+	T Value;
+};
+
+template<typename T>
+_FORCE_INLINE_ bool
+operator==(BenchBytesKey<T> left, BenchBytesKey<T> right)
+{
+	return left.Value == right.Value;
+}
+
+_FORCE_INLINE_ internal void
+InternalSetKey(Vec2i* key, Vec2i value)
+{
+	*key = value;
+}
+
+_FORCE_INLINE_ internal void
+InternalSetKey(void** key, void* value)
+{
+	*key = value;
+}
+
+template<typename T>
+_FORCE_INLINE_ void
+InternalSetKey(BenchBytesKey<T>* key, T value)
+{
+	key->Value = value;
+}
+
+template<typename K>
+internal void
+InternalMeasureProbes(HashMapT<K, u32>* map, BenchTimings* outTimings)
+{
+	u64 total = 0;
+	u32 max = 0;
+	for (u32 i = 0; i < map->Capacity; ++i)
+	{
+		if (!HashMapTIsUsed(map, i))
+			continue;
+
+		total += map->Buckets[i].ProbeLength;
+		max = Max(max, (u32)map->Buckets[i].ProbeLength);
+	}
+	outTimings->ProbeAvg = (map->Count) ? (float)((double)total / (double)map->Count) : 0.0f;
+	outTimings->ProbeMax = max;
+	outTimings->HasProbes = true;
+}
+
+template<typename K>
+internal void
+InternalBenchTable(BenchContext* ctx, K* keys, K* misses, u32 count, u32 capacity, BenchTimings* outTimings)
+{
+	u64 sink = 0;
+	double start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		sink += Hash(&keys[i]);
+	}
+	outTimings->Seconds[BENCH_OP_HASH] = BenchNow() - start;
+
+	HashMapT<K, u32> map = {};
+	HashMapTInitialize(&map, 0, SAllocatorMalloc());
+	HashMapTReserve(&map, capacity);
+
+	start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		HashMapTSet(&map, &keys[i], &i);
+	}
+	outTimings->Seconds[BENCH_OP_INSERT] = BenchNow() - start;
+	outTimings->Load = (float)map.Count / (float)map.Capacity;
+	InternalMeasureProbes(&map, outTimings);
+
+	start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		sink += *HashMapTGet(&map, &keys[i]);
+	}
+	outTimings->Seconds[BENCH_OP_LOOKUP_HIT] = BenchNow() - start;
+
+	start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		sink += (HashMapTGet(&map, &misses[i]) == nullptr);
+	}
+	outTimings->Seconds[BENCH_OP_LOOKUP_MISS] = BenchNow() - start;
+
+	outTimings->Count = count;
+	ctx->Sink += sink;
+
+	HashMapTDestroy(&map);
+}
+
+// Tile and region coords, a dense square around 0. Misses are the same square moved away.
+template<typename K>
+internal void
+BenchVec2iKeys(BenchContext* ctx, u32 size, float load, BenchTimings* outTimings)
+{
+	u32 count = (u32)((float)size * load);
+	int side = (int)ceilf(sqrtf((float)count));
+	K* keys = (K*)SAlloc(SAllocatorMalloc(), count * sizeof(K));
+	K* misses = (K*)SAlloc(SAllocatorMalloc(), count * sizeof(K));
+	for (u32 i = 0; i < count; ++i)
+	{
+		Vec2i tile = { (int)i % side - side / 2, (int)i / side - side / 2 };
+		InternalSetKey(&keys[i], tile);
+		InternalSetKey(&misses[i], tile.Add({ side * 4, 0 }));
+	}
+
+	InternalBenchTable(ctx, keys, misses, count, size, outTimings);
+
+	SFree(SAllocatorMalloc(), keys);
+	SFree(SAllocatorMalloc(), misses);
+}
+
+// Allocation addresses, like the memory tracking map. 16 byte stride, misses are in between.
+template<typename K>
+internal void
+BenchPointerKeys(BenchContext* ctx, u32 size, float load, BenchTimings* outTimings)
+{
+	u32 count = (u32)((float)size * load);
+	uintptr_t base = (uintptr_t)0x10000000;
+	K* keys = (K*)SAlloc(SAllocatorMalloc(), count * sizeof(K));
+	K* misses = (K*)SAlloc(SAllocatorMalloc(), count * sizeof(K));
+	for (u32 i = 0; i < count; ++i)
+	{
+		InternalSetKey(&keys[i], (void*)(base + (uintptr_t)i * 16));
+		InternalSetKey(&misses[i], (void*)(base + (uintptr_t)i * 16 + 8));
+	}
+
+	InternalBenchTable(ctx, keys, misses, count, size, outTimings);
+
+	SFree(SAllocatorMalloc(), keys);
+	SFree(SAllocatorMalloc(), misses);
+}
+
+constant_var u32 BENCH_HASH_SIZES[] = { 1024, 16384, 262144 };
+constant_var float BENCH_HASH_LOADS[] = { 0.5f, 0.75f };
+
+void BenchHashing(BenchContext* ctx)
+{
+	for (int i = 0; i < ArrayLength(BENCH_HASH_SIZES); ++i)
+	{
+		for (int j = 0; j < ArrayLength(BENCH_HASH_LOADS); ++j)
+		{
+			u32 size = BENCH_HASH_SIZES[i];
+			float load = BENCH_HASH_LOADS[j];
+			BenchRun(ctx, "Hash.Vec2i.mix", BenchVec2iKeys<Vec2i>, size, load);
+			BenchRun(ctx, "Hash.Vec2i.wyhash", BenchVec2iKeys<BenchBytesKey<Vec2i>>, size, load);
+			BenchRun(ctx, "Hash.ptr.mix", BenchPointerKeys<void*>, size, load);
+			BenchRun(ctx, "Hash.ptr.wyhash", BenchPointerKeys<BenchBytesKey<void*>>, size, load);
+		}
+	}
+}
@@ -0,0 +1,91 @@
+#define ZPL_IMPL
+#include <zpl/zpl.h>
+
+#define FNL_IMPL
+#include <FastNoiseLite/FastNoiseLite.h>
+
+#include "Bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Usage: Bench [filter] [repeats]
+
+bool BenchShouldRun(BenchContext* ctx, const char* suite)
+{
+	return !ctx->Filter || strstr(suite, ctx->Filter);
+}
+
+void BenchRun(BenchContext* ctx, const char* suite, BenchRunFunc fn, u32 size, float load)
+{
+	if (!BenchShouldRun(ctx, suite))
+		return;
+
+	BenchTimings best = {};
+	for (int op = 0; op < BENCH_OP_COUNT; ++op)
+		best.Seconds[op] = -1.0;
+
+	for (int repeat = 0; repeat < ctx->Repeats; ++repeat)
+	{
+		BenchTimings timings = {};
+		for (int op = 0; op < BENCH_OP_COUNT; ++op)
+			timings.Seconds[op] = -1.0;
+
+		fn(ctx, size, load, &timings);
+		best.Count = timings.Count;
+		best.Load = timings.Load;
+		best.ProbeAvg = timings.ProbeAvg;
+		best.ProbeMax = timings.ProbeMax;
+		best.HasProbes = timings.HasProbes;
+
+		for (int op = 0; op < BENCH_OP_COUNT; ++op)
+		{
+			if (timings.Seconds[op] < 0.0)
+				continue;
+			if (best.Seconds[op] < 0.0 || timings.Seconds[op] < best.Seconds[op])
+				best.Seconds[op] = timings.Seconds[op];
+		}
+	}
+
+	for (int op = 0; op < BENCH_OP_COUNT; ++op)
+	{
+		if (best.Seconds[op] < 0.0 || best.Count == 0)
+			continue;
+
+		double nsPerOp = best.Seconds[op] * 1000000000.0 / (double)best.Count;
+		printf("%s,%s,%u,%.2f,%.3f", suite, BENCH_OP_NAMES[op], best.Count, best.Load, nsPerOp);
+		if (best.HasProbes)
+			printf(",%.3f,%u\n", best.ProbeAvg, best.ProbeMax);
+		else
+			printf(",,\n");
+	}
+	fflush(stdout);
+}
+
+int
+main(int argCount, char** args)
+{
+	BenchContext ctx = {};
+	ctx.Filter = (argCount > 1 && strcmp(args[1], "all") != 0) ? args[1] : nullptr;
+	ctx.Repeats = (argCount > 2) ? atoi(args[2]) : 5;
+	if (ctx.Repeats <= 0)
+	{
+		printf("Usage: Bench [filter|all] [repeats]\n");
+		return 1;
+	}
+
+	// Allocation tracking adds a hash map update per container resize
+	InitializeMemoryTracking();
+
+	printf("suite,op,count,load,ns_per_op,probe_avg,probe_max\n");
+
+	BenchStructures(&ctx);
+	BenchHashing(&ctx);
+
+	// Keeps Sink alive
+	fprintf(stderr, "sink=%llu\n", (unsigned long long)ctx.Sink);
+
+	ShutdownMemoryTracking();
+	return 0;
+}
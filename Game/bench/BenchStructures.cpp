@@ -0,0 +1,585 @@
+#include "Bench.h"
+
+#include "Lib/Random.h"
+#include "Lib/String.h"
+
+#include "Structures/HashMapT.h"
+#include "Structures/HashMapSwiss.h"
+#include "Structures/HashSetT.h"
+#include "Structures/HashMapStr.h"
+#include "Structures/SparseSet.h"
+#include "Structures/SList.h"
+#include "Structures/SegmentedList.h"
+#include "Structures/ArrayList.h"
+#include "Structures/BHeap.h"
+#include "Structures/QueueThreaded.h"
+
+#include <stdio.h>
+
+// Keys are random u64s, hashed with HashTraits' integer mix. BenchHashing
+// covers the other key types.
+
+constant_var u32 BENCH_SIZES[] = { 1024, 16384, 262144 };
+constant_var float BENCH_LOADS[] = { 0.25f, 0.5f, 0.75f };
+
+// SparseSet ids are u16
+constant_var u32 BENCH_SPARSE_SET_MAX = 65534;
+
+constant_var int BENCH_QUEUE_CAPACITY = 65536;
+
+// Even keys are inserted, odd keys are used for misses
+internal u64*
+InternalMakeKeys(u32 count, u64 seed, bool odd)
+{
+	u64* keys = (u64*)SAlloc(SAllocatorMalloc(), count * sizeof(u64));
+	SRandom random;
+	SRandomInitialize(&random, seed);
+	for (u32 i = 0; i < count; ++i)
+	{
+		keys[i] = (SRandNext(&random) << 1) | (u64)odd;
+	}
+	return keys;
+}
+
+internal void
+InternalFreeKeys(u64* keys)
+{
+	SFree(SAllocatorMalloc(), keys);
+}
+
+_FORCE_INLINE_ internal u32
+InternalFillCount(u32 capacity, float load)
+{
+	return (u32)((float)capacity * load);
+}
+
+// *************
+// Hash containers
+
+internal void
+BenchHashMapT(BenchContext* ctx, u32 size, float load, BenchTimings* outTimings)
+{
+	u32 count = InternalFillCount(size, load);
+	u64* keys = InternalMakeKeys(count, 1, false);
+	u64* misses = InternalMakeKeys(count, 2, true);
+
+	HashMapT<u64, u64> map = {};
+	HashMapTInitialize(&map, 0, SAllocatorMalloc());
+	HashMapTReserve(&map, size);
+
+	u64 sink = 0;
+	double start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		HashMapTSet(&map, &keys[i], &keys[i]);
+	}
+	outTimings->Seconds[BENCH_OP_INSERT] = BenchNow() - start;
+	outTimings->Load = (float)map.Count / (float)map.Capacity;
+
+	start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		sink += *HashMapTGet(&map, &keys[i]);
+	}
+	outTimings->Seconds[BENCH_OP_LOOKUP_HIT] = BenchNow() - start;
+
+	start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		sink += (HashMapTGet(&map, &misses[i]) == nullptr);
+	}
+	outTimings->Seconds[BENCH_OP_LOOKUP_MISS] = BenchNow() - start;
+
+	start = BenchNow();
+	for (u32 i = 0; i < map.Capacity; ++i)
+	{
+		if (HashMapTIsUsed(&map, i))
+			sink += map.Buckets[i].Value;
+	}
+	outTimings->Seconds[BENCH_OP_ITERATE] = BenchNow() - start;
+
+	start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		sink += HashMapTRemove(&map, &keys[i]);
+	}
+	outTimings->Seconds[BENCH_OP_ERASE] = BenchNow() - start;
+
+	outTimings->Count = count;
+	ctx->Sink += sink;
+
+	HashMapTDestroy(&map);
+	InternalFreeKeys(keys);
+	InternalFreeKeys(misses);
+}
+
+internal void
+BenchHashMapSwiss(BenchContext* ctx, u32 size, float load, BenchTimings* outTimings)
+{
+	u32 count = InternalFillCount(size, load);
+	u64* keys = InternalMakeKeys(count, 1, false);
+	u64* misses = InternalMakeKeys(count, 2, true);
+
+	HashMapSwiss<u64, u64> map = {};
+	HashMapSwissInitialize(&map, 0, SAllocatorMalloc());
+	HashMapSwissReserve(&map, size);
+
+	u64 sink = 0;
+	double start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		HashMapSwissSet(&map, &keys[i], &keys[i]);
+	}
+	outTimings->Seconds[BENCH_OP_INSERT] = BenchNow() - start;
+	outTimings->Load = (float)map.Count / (float)map.Capacity;
+
+	start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		sink += *HashMapSwissGet(&map, &keys[i]);
+	}
+	outTimings->Seconds[BENCH_OP_LOOKUP_HIT] = BenchNow() - start;
+
+	start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		sink += (HashMapSwissGet(&map, &misses[i]) == nullptr);
+	}
+	outTimings->Seconds[BENCH_OP_LOOKUP_MISS] = BenchNow() - start;
+
+	start = BenchNow();
+	for (u32 i = 0; i < map.Capacity; ++i)
+	{
+		if (map.Control[i] != HASHMAPSWISS_EMPTY)
+			sink += map.Values[i];
+	}
+	outTimings->Seconds[BENCH_OP_ITERATE] = BenchNow() - start;
+
+	start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		sink += HashMapSwissRemove(&map, &keys[i]);
+	}
+	outTimings->Seconds[BENCH_OP_ERASE] = BenchNow() - start;
+
+	outTimings->Count = count;
+	ctx->Sink += sink;
+
+	HashMapSwissDestroy(&map);
+	InternalFreeKeys(keys);
+	InternalFreeKeys(misses);
+}
+
+internal void
+BenchHashSetT(BenchContext* ctx, u32 size, float load, BenchTimings* outTimings)
+{
+	u32 count = InternalFillCount(size, load);
+	u64* keys = InternalMakeKeys(count, 1, false);
+	u64* misses = InternalMakeKeys(count, 2, true);
+
+	HashSetT<u64> set = {};
+	HashSetTInitialize(&set, 0, SAllocatorMalloc());
+	HashSetTReserve(&set, size);
+
+	u64 sink = 0;
+	double start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		HashSetTSet(&set, &keys[i]);
+	}
+	outTimings->Seconds[BENCH_OP_INSERT] = BenchNow() - start;
+	outTimings->Load = (float)set.Count / (float)set.Capacity;
+
+	start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		sink += HashSetTContains(&set, &keys[i]);
+	}
+	outTimings->Seconds[BENCH_OP_LOOKUP_HIT] = BenchNow() - start;
+
+	start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		sink += HashSetTContains(&set, &misses[i]);
+	}
+	outTimings->Seconds[BENCH_OP_LOOKUP_MISS] = BenchNow() - start;
+
+	start = BenchNow();
+	for (u32 i = 0; i < set.Capacity; ++i)
+	{
+		if (HashSetTIsUsed(&set, i))
+			sink += set.Keys[i].Key;
+	}
+	outTimings->Seconds[BENCH_OP_ITERATE] = BenchNow() - start;
+
+	start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		sink += HashSetTRemove(&set, &keys[i]);
+	}
+	outTimings->Seconds[BENCH_OP_ERASE] = BenchNow() - start;
+
+	outTimings->Count = count;
+	ctx->Sink += sink;
+
+	HashSetTDestroy(&set);
+	InternalFreeKeys(keys);
+	InternalFreeKeys(misses);
+}
+
+internal String*
+InternalMakeStringKeys(u64* keys, u32 count)
+{
+	String* strings = (String*)SAlloc(SAllocatorMalloc(), count * sizeof(String));
+	char buffer[32];
+	for (u32 i = 0; i < count; ++i)
+	{
+		snprintf(buffer, sizeof(buffer), "%llx", (unsigned long long)keys[i]);
+		strings[i] = StringMake(SAllocatorMalloc(), buffer);
+	}
+	return strings;
+}
+
+internal void
+InternalFreeStringKeys(String* strings, u32 count)
+{
+	for (u32 i = 0; i < count; ++i)
+	{
+		StringFree(SAllocatorMalloc(), strings[i]);
+	}
+	SFree(SAllocatorMalloc(), strings);
+}
+
+internal void
+BenchHashMapStr(BenchContext* ctx, u32 size, float load, BenchTimings* outTimings)
+{
+	u32 count = InternalFillCount(size, load);
+	u64* keys = InternalMakeKeys(count, 1, false);
+	u64* misses = InternalMakeKeys(count, 2, true);
+	String* keyStrings = InternalMakeStringKeys(keys, count);
+	String* missStrings = InternalMakeStringKeys(misses, count);
+
+	HashMapStr<u64> map = {};
+	HashMapStrInitialize(&map, 0, SAllocatorMalloc());
+	HashMapStrReserve(&map, size);
+
+	u64 sink = 0;
+	double start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		HashMapStrSet(&map, keyStrings[i], &keys[i]);
+	}
+	outTimings->Seconds[BENCH_OP_INSERT] = BenchNow() - start;
+	outTimings->Load = (float)map.Count / (float)map.Capacity;
+
+	start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		sink += *HashMapStrGet(&map, keyStrings[i]);
+	}
+	outTimings->Seconds[BENCH_OP_LOOKUP_HIT] = BenchNow() - start;
+
+	start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		sink += (HashMapStrGet(&map, missStrings[i]) == nullptr);
+	}
+	outTimings->Seconds[BENCH_OP_LOOKUP_MISS] = BenchNow() - start;
+
+	start = BenchNow();
+	for (u32 i = 0; i < map.Capacity; ++i)
+	{
+		if (map.Buckets[i].IsUsed)
+			sink += map.Values[i];
+	}
+	outTimings->Seconds[BENCH_OP_ITERATE] = BenchNow() - start;
+
+	start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		sink += HashMapStrRemove(&map, keyStrings[i]);
+	}
+	outTimings->Seconds[BENCH_OP_ERASE] = BenchNow() - start;
+
+	outTimings->Count = count;
+	ctx->Sink += sink;
+
+	HashMapStrFree(&map);
+	InternalFreeStringKeys(keyStrings, count);
+	InternalFreeStringKeys(missStrings, count);
+	InternalFreeKeys(keys);
+	InternalFreeKeys(misses);
+}
+
+// *************
+// Sequential containers
+
+internal void
+BenchSparseSet(BenchContext* ctx, u32 size, float load, BenchTimings* outTimings)
+{
+	u32 count = Min(size, BENCH_SPARSE_SET_MAX);
+	u64* keys = InternalMakeKeys(count, 1, false);
+	u16* ids = (u16*)SAlloc(SAllocatorMalloc(), count * sizeof(u16));
+
+	SparseSet<u64> set = {};
+	set.Initialize(SAllocatorMalloc(), count);
+
+	u64 sink = 0;
+	double start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		ids[i] = set.Add(&keys[i]);
+	}
+	outTimings->Seconds[BENCH_OP_INSERT] = BenchNow() - start;
+
+	start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		sink += *set.Get(ids[i]);
+	}
+	outTimings->Seconds[BENCH_OP_LOOKUP_HIT] = BenchNow() - start;
+
+	start = BenchNow();
+	for (u32 i = 0; i < set.Count; ++i)
+	{
+		sink += set.Dense[i].Value;
+	}
+	outTimings->Seconds[BENCH_OP_ITERATE] = BenchNow() - start;
+
+	start = BenchNow();
+	for (u32 i = 0; i < count; ++i)
+	{
+		set.Remove(ids[i]);
+	}
+	outTimings->Seconds[BENCH_OP_ERASE] = BenchNow() - start;
+
+	outTimings->Count = count;
+	ctx->Sink += sink;
+
+	SFree(SAllocatorMalloc(), set.Sparse);
+	SFree(SAllocatorMalloc(), set.Dense);
+	SFree(SAllocatorMalloc(), ids);
+	InternalFreeKeys(keys);
+}
+
+internal void
+BenchSList(BenchContext* ctx, u32 size, float load, BenchTimings* outTimings)
+{
+	u64* keys = InternalMakeKeys(size, 1, false);
+
+	SList<u64> list = {};
+	list.Reserve(SAllocatorMalloc(), 1);
+
+	u64 sink = 0;
+	double start = BenchNow();
+	for (u32 i = 0; i < size; ++i)
+	{
+		list.Push(&keys[i]);
+	}
+	outTimings->Seconds[BENCH_OP_INSERT] = BenchNow() - start;
+
+	start = BenchNow();
+	for (u32 i = 0; i < list.Count; ++i)
+	{
+		sink += list.Memory[i];
+	}
+	outTimings->Seconds[BENCH_OP_ITERATE] = BenchNow() - start;
+
+	start = BenchNow();
+	while (list.Count > 0)
+	{
+		list.RemoveAtFast(0);
+	}
+	outTimings->Seconds[BENCH_OP_ERASE] = BenchNow() - start;
+
+	outTimings->Count = size;
+	ctx->Sink += sink;
+
+	list.Free();
+	InternalFreeKeys(keys);
+}
+
+// Same ops as BenchSList, growing allocates a segment instead of copying
+internal void
+BenchSegmentedList(BenchContext* ctx, u32 size, float load, BenchTimings* outTimings)
+{
+	u64* keys = InternalMakeKeys(size, 1, false);
+
+	SegmentedList<u64> list;
+	SegmentedListInitialize(&list, SAllocatorMalloc());
+
+	u64 sink = 0;
+	double start = BenchNow();
+	for (u32 i = 0; i < size; ++i)
+	{
+		SegmentedListPush(&list, &keys[i]);
+	}
+	outTimings->Seconds[BENCH_OP_INSERT] = BenchNow() - start;
+
+	start = BenchNow();
+	SegmentedListForEach(&list, [&sink](u64* element) { sink += *element; });
+	outTimings->Seconds[BENCH_OP_ITERATE] = BenchNow() - start;
+
+	// Indexed reads, the bit scan per element instead of walking segments
+	start = BenchNow();
+	for (u32 i = 0; i < list.Count; ++i)
+	{
+		sink += *SegmentedListAt(&list, i);
+	}
+	outTimings->Seconds[BENCH_OP_LOOKUP_HIT] = BenchNow() - start;
+
+	start = BenchNow();
+	while (list.Count > 0)
+	{
+		SegmentedListRemoveAtFast(&list, 0);
+	}
+	outTimings->Seconds[BENCH_OP_ERASE] = BenchNow() - start;
+
+	outTimings->Count = size;
+	ctx->Sink += sink;
+
+	SegmentedListDestroy(&list);
+	InternalFreeKeys(keys);
+}
+
+internal void
+BenchArrayList(BenchContext* ctx, u32 size, float load, BenchTimings* outTimings)
+{
+	u64* keys = InternalMakeKeys(size, 1, false);
+
+	ArrayList(u64) list = nullptr;
+
+	u64 sink = 0;
+	double start = BenchNow();
+	for (u32 i = 0; i < size; ++i)
+	{
+		ArrayListPush(SAllocatorMalloc(), list, keys[i]);
+	}
+	outTimings->Seconds[BENCH_OP_INSERT] = BenchNow() - start;
+
+	start = BenchNow();
+	for (int i = 0; i < ArrayListCount(list); ++i)
+	{
+		sink += list[i];
+	}
+	outTimings->Seconds[BENCH_OP_ITERATE] = BenchNow() - start;
+
+	start = BenchNow();
+	while (ArrayListCount(list) > 0)
+	{
+		ArrayListPop(list, 0);
+	}
+	outTimings->Seconds[BENCH_OP_ERASE] = BenchNow() - start;
+
+	outTimings->Count = size;
+	ctx->Sink += sink;
+
+	ArrayListFree(SAllocatorMalloc(), list);
+	InternalFreeKeys(keys);
+}
+
+internal int
+InternalCompareU64(void* v0, void* v1)
+{
+	u64 a = *(u64*)v0;
+	u64 b = *(u64*)v1;
+	return (a < b) ? -1 : (a > b) ? 1 : 0;
+}
+
+// Insert is push, erase is pop min
+internal void
+BenchBHeap(BenchContext* ctx, u32 size, float load, BenchTimings* outTimings)
+{
+	u64* keys = InternalMakeKeys(size, 1, false);
+
+	BHeap* heap = BHeapCreate(SAllocatorMalloc(), InternalCompareU64, (int)size);
+
+	u64 sink = 0;
+	double start = BenchNow();
+	for (u32 i = 0; i < size; ++i)
+	{
+		BHeapPushMin(heap, &keys[i], nullptr);
+	}
+	outTimings->Seconds[BENCH_OP_INSERT] = BenchNow() - start;
+
+	start = BenchNow();
+	while (!BHeapEmpty(heap))
+	{
+		BHeapItem item = BHeapPopMin(heap);
+		sink += *(u64*)item.Key;
+	}
+	outTimings->Seconds[BENCH_OP_ERASE] = BenchNow() - start;
+
+	outTimings->Count = size;
+	ctx->Sink += sink;
+
+	BHeapDestroy(heap, SAllocatorMalloc());
+	InternalFreeKeys(keys);
+}
+
+// Single threaded, measures the atomics cost only. Insert is enqueue, erase is dequeue.
+internal void
+BenchQueueThreaded(BenchContext* ctx, u32 size, float load, BenchTimings* outTimings)
+{
+	u64* keys = InternalMakeKeys(size, 1, false);
+
+	typedef QueueThreaded<u64, BENCH_QUEUE_CAPACITY> BenchQueue;
+	BenchQueue* queue = (BenchQueue*)SAlloc(SAllocatorMalloc(), sizeof(BenchQueue));
+	SZero(queue, sizeof(BenchQueue));
+
+	u64 sink = 0;
+	double enqueueSeconds = 0;
+	double dequeueSeconds = 0;
+	u32 batchSize = BENCH_QUEUE_CAPACITY / 2;
+	for (u32 batch = 0; batch < size; batch += batchSize)
+	{
+		u32 end = Min(batch + batchSize, size);
+
+		double start = BenchNow();
+		for (u32 i = batch; i < end; ++i)
+		{
+			queue->Enqueue(&keys[i]);
+		}
+		enqueueSeconds += BenchNow() - start;
+
+		start = BenchNow();
+		u64 value;
+		while (queue->Dequeue(&value))
+		{
+			sink += value;
+		}
+		dequeueSeconds += BenchNow() - start;
+	}
+	outTimings->Seconds[BENCH_OP_INSERT] = enqueueSeconds;
+	outTimings->Seconds[BENCH_OP_ERASE] = dequeueSeconds;
+
+	outTimings->Count = size;
+	ctx->Sink += sink;
+
+	SFree(SAllocatorMalloc(), queue);
+	InternalFreeKeys(keys);
+}
+
+void BenchStructures(BenchContext* ctx)
+{
+	for (int i = 0; i < ArrayLength(BENCH_SIZES); ++i)
+	{
+		for (int j = 0; j < ArrayLength(BENCH_LOADS); ++j)
+		{
+			BenchRun(ctx, "HashMapT", BenchHashMapT, BENCH_SIZES[i], BENCH_LOADS[j]);
+			BenchRun(ctx, "HashMapSwiss", BenchHashMapSwiss, BENCH_SIZES[i], BENCH_LOADS[j]);
+			BenchRun(ctx, "HashSetT", BenchHashSetT, BENCH_SIZES[i], BENCH_LOADS[j]);
+			BenchRun(ctx, "HashMapStr", BenchHashMapStr, BENCH_SIZES[i], BENCH_LOADS[j]);
+		}
+	}
+
+	for (int i = 0; i < ArrayLength(BENCH_SIZES); ++i)
+	{
+		BenchRun(ctx, "SparseSet", BenchSparseSet, BENCH_SIZES[i], 0);
+		BenchRun(ctx, "SList", BenchSList, BENCH_SIZES[i], 0);
+		BenchRun(ctx, "SegmentedList", BenchSegmentedList, BENCH_SIZES[i], 0);
+		BenchRun(ctx, "ArrayList", BenchArrayList, BENCH_SIZES[i], 0);
+		BenchRun(ctx, "BHeap", BenchBHeap, BENCH_SIZES[i], 0);
+		BenchRun(ctx, "QueueThreaded", BenchQueueThreaded, BENCH_SIZES[i], 0);
+	}
+}
@@ -0,0 +1,132 @@
+#include "ChunkTexturePool.h"
+
+#include "RenderUtils.h"
+
+ChunkTextureBackend
+ChunkTextureBackendRaylib()
+{
+	ChunkTextureBackend backend;
+	backend.Load = [](int size)
+	{
+		return LoadRenderTextureEx({ size, size }, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, false);
+	};
+	backend.Unload = [](RenderTexture2D texture)
+	{
+		UnloadRenderTexture(texture);
+	};
+	return backend;
+}
+
+void
+ChunkTexturePoolCreate(ChunkTexturePool* pool, SAllocator allocator, int slotCount, int textureSize, ChunkTextureBackend backend)
+{
+	SAssert(pool);
+	SAssert(slotCount > 0);
+	SAssert(textureSize > 0);
+	SAssert(backend.Load);
+	SAssert(backend.Unload);
+
+	pool->Backend = backend;
+	pool->Allocator = allocator;
+	pool->Frame = 1;
+	pool->SlotCount = slotCount;
+	pool->TextureSize = textureSize;
+	pool->Slots = (ChunkTextureSlot*)SAlloc(allocator, slotCount * sizeof(ChunkTextureSlot));
+	SAssert(pool->Slots);
+
+	// Textures are loaded on first use
+	for (int i = 0; i < slotCount; ++i)
+	{
+		pool->Slots[i] = {};
+		pool->Slots[i].Owner = CHUNK_TEXTURE_NO_OWNER;
+	}
+}
+
+void
+ChunkTexturePoolDestroy(ChunkTexturePool* pool)
+{
+	SAssert(pool);
+	for (int i = 0; i < pool->SlotCount; ++i)
+	{
+		if (pool->Slots[i].IsLoaded)
+			pool->Backend.Unload(pool->Slots[i].Texture);
+	}
+	SFree(pool->Allocator, pool->Slots);
+	*pool = {};
+}
+
+void
+ChunkTexturePoolNextFrame(ChunkTexturePool* pool)
+{
+	SAssert(pool);
+	++pool->Frame;
+}
+
+int
+ChunkTexturePoolAcquire(ChunkTexturePool* pool, u32 owner, int slot, bool* wasAssigned)
+{
+	SAssert(pool);
+	SAssert(wasAssigned);
+	SAssert(owner != CHUNK_TEXTURE_NO_OWNER);
+
+	if (slot >= 0 && slot < pool->SlotCount && pool->Slots[slot].Owner == owner)
+	{
+		pool->Slots[slot].LastUsedFrame = pool->Frame;
+		*wasAssigned = false;
+		return slot;
+	}
+
+	// Free slots first, then the least recently used one not used this frame
+	int bestSlot = CHUNK_TEXTURE_INVALID_SLOT;
+	u64 bestFrame = pool->Frame;
+	for (int i = 0; i < pool->SlotCount; ++i)
+	{
+		ChunkTextureSlot* candidate = &pool->Slots[i];
+		if (candidate->Owner == CHUNK_TEXTURE_NO_OWNER)
+		{
+			bestSlot = i;
+			break;
+		}
+		else if (candidate->LastUsedFrame < bestFrame)
+		{
+			bestSlot = i;
+			bestFrame = candidate->LastUsedFrame;
+		}
+	}
+
+	*wasAssigned = false;
+	if (bestSlot == CHUNK_TEXTURE_INVALID_SLOT)
+		return CHUNK_TEXTURE_INVALID_SLOT;
+
+	ChunkTextureSlot* newSlot = &pool->Slots[bestSlot];
+	if (!newSlot->IsLoaded)
+	{
+		newSlot->Texture = pool->Backend.Load(pool->TextureSize);
+		newSlot->IsLoaded = true;
+	}
+	newSlot->Owner = owner;
+	newSlot->LastUsedFrame = pool->Frame;
+	*wasAssigned = true;
+	return bestSlot;
+}
+
+RenderTexture2D*
+ChunkTexturePoolGet(ChunkTexturePool* pool, u32 owner, int slot)
+{
+	SAssert(pool);
+	if (slot >= 0 && slot < pool->SlotCount && pool->Slots[slot].Owner == owner)
+		return &pool->Slots[slot].Texture;
+	else
+		return nullptr;
+}
+
+void
+ChunkTexturePoolRelease(ChunkTexturePool* pool, u32 owner, int slot)
+{
+	SAssert(pool);
+	if (slot >= 0 && slot < pool->SlotCount && pool->Slots[slot].Owner == owner)
+	{
+		pool->Slots[slot].Owner = CHUNK_TEXTURE_NO_OWNER;
+		pool->Slots[slot].LastUsedFrame = 0;
+	}
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Core.h"
+#include "Memory.h"
+
+// Fixed count of chunk render textures shared by chunks near the camera.
+// Chunks keep the slot index they were given, the slot is only theirs while
+// the slot's Owner still matches. Evicted chunks find out on their next acquire.
+
+constant_var int CHUNK_TEXTURE_POOL_SIZE = VIEW_DISTANCE_TOTAL_CHUNKS;
+constant_var int CHUNK_TEXTURE_INVALID_SLOT = -1;
+constant_var u32 CHUNK_TEXTURE_NO_OWNER = UINT32_MAX;
+
+// Creates and frees the GPU side, swapped with a mock when testing
+struct ChunkTextureBackend
+{
+	RenderTexture2D(*Load)(int size);
+	void(*Unload)(RenderTexture2D texture);
+};
+
+struct ChunkTextureSlot
+{
+	RenderTexture2D Texture;
+	u64 LastUsedFrame;
+	u32 Owner;
+	bool IsLoaded;
+};
+
+struct ChunkTexturePool
+{
+	ChunkTextureBackend Backend;
+	SAllocator Allocator;
+	ChunkTextureSlot* Slots;
+	u64 Frame;
+	int SlotCount;
+	int TextureSize;
+};
+
+ChunkTextureBackend ChunkTextureBackendRaylib();
+
+void ChunkTexturePoolCreate(ChunkTexturePool* pool, SAllocator allocator, int slotCount, int textureSize, ChunkTextureBackend backend);
+void ChunkTexturePoolDestroy(ChunkTexturePool* pool);
+
+// Slots acquired in the current frame are never evicted
+void ChunkTexturePoolNextFrame(ChunkTexturePool* pool);
+
+// Returns owner's slot, reusing slot if owner still holds it. Otherwise takes a free
+// slot or evicts the least recently used one and sets wasAssigned, the texture then
+// holds stale contents and the owner needs a full rebake.
+// Returns CHUNK_TEXTURE_INVALID_SLOT if every slot was already used this frame.
+int ChunkTexturePoolAcquire(ChunkTexturePool* pool, u32 owner, int slot, bool* wasAssigned);
+
+// Returns nullptr if owner no longer holds slot
+RenderTexture2D* ChunkTexturePoolGet(ChunkTexturePool* pool, u32 owner, int slot);
+
+void ChunkTexturePoolRelease(ChunkTexturePool* pool, u32 owner, int slot);
+
+inline void TestChunkTexturePool()
+{
+	ChunkTextureBackend mockBackend;
+	mockBackend.Load = [](int size)
+	{
+		local_persist u32 NextId;
+		RenderTexture2D texture = {};
+		texture.id = ++NextId;
+		texture.texture.id = texture.id;
+		texture.texture.width = size;
+		texture.texture.height = size;
+		return texture;
+	};
+	mockBackend.Unload = [](RenderTexture2D texture) {};
+
+	ChunkTexturePool pool = {};
+	ChunkTexturePoolCreate(&pool, SAllocatorMalloc(), 2, 16, mockBackend);
+
+	bool wasAssigned;
+	int slot0 = ChunkTexturePoolAcquire(&pool, 0, CHUNK_TEXTURE_INVALID_SLOT, &wasAssigned);
+	SAssert(slot0 != CHUNK_TEXTURE_INVALID_SLOT);
+	SAssert(wasAssigned);
+
+	int slot1 = ChunkTexturePoolAcquire(&pool, 1, CHUNK_TEXTURE_INVALID_SLOT, &wasAssigned);
+	SAssert(slot1 != CHUNK_TEXTURE_INVALID_SLOT && slot1 != slot0);
+
+	// Full and both used this frame
+	int slot2 = ChunkTexturePoolAcquire(&pool, 2, CHUNK_TEXTURE_INVALID_SLOT, &wasAssigned);
+	SAssert(slot2 == CHUNK_TEXTURE_INVALID_SLOT);
+
+	// Only owner 1 is touched, owner 0 becomes least recently used
+	ChunkTexturePoolNextFrame(&pool);
+	SAssert(ChunkTexturePoolAcquire(&pool, 1, slot1, &wasAssigned) == slot1);
+	SAssert(!wasAssigned);
+
+	slot2 = ChunkTexturePoolAcquire(&pool, 2, CHUNK_TEXTURE_INVALID_SLOT, &wasAssigned);
+	SAssert(slot2 == slot0);
+	SAssert(wasAssigned);
+	SAssert(ChunkTexturePoolGet(&pool, 2, slot2));
+	SAssert(!ChunkTexturePoolGet(&pool, 0, slot0));
+	SAssert(ChunkTexturePoolGet(&pool, 2, slot2)->texture.width == 16);
+
+	// Owner 0 reacquires and needs a rebake
+	ChunkTexturePoolNextFrame(&pool);
+	ChunkTexturePoolAcquire(&pool, 2, slot2, &wasAssigned);
+	slot0 = ChunkTexturePoolAcquire(&pool, 0, slot0, &wasAssigned);
+	SAssert(slot0 == slot1);
+	SAssert(wasAssigned);
+
+	ChunkTexturePoolRelease(&pool, 0, slot0);
+	SAssert(!ChunkTexturePoolGet(&pool, 0, slot0));
+	SAssert(ChunkTexturePoolAcquire(&pool, 3, CHUNK_TEXTURE_INVALID_SLOT, &wasAssigned) == slot0);
+
+	ChunkTexturePoolDestroy(&pool);
+}
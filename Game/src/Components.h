@@ -10,6 +10,7 @@
 struct CTransform
 {
 	Vec2 Pos;
+	Vec2 PrevPos; // Pos at the start of the last tick, rendering interpolates from it
 	Vec2i TilePos;
 };
 
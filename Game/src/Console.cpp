@@ -2,6 +2,7 @@
 
 #include "GameState.h"
 #include "GUI.h"
+#include "Scratch.h"
 
 #include "Structures/Queue.h"
 #include "Structures/HashMapStr.h"
@@ -61,6 +62,76 @@ void ConsoleInit()
 		return COMMAND_SUCCESS;
 	};
 	ConsoleRegisterCommand(StringMake(SAllocatorArena(&GetGameState()->GameArena), "TestCommand"), &cmd);
+
+	cmd.ArgumentString = StringMake(SAllocatorArena(&GetGameState()->GameArena), "[passes]");
+	cmd.OnCommand = [](const String cmd, const char** args, int argCount)
+	{
+		// args[0] is the empty string before the first space
+		int passes = (argCount > 0) ? atoi(args[1]) : 8;
+		if (passes <= 0)
+			return COMMAND_FAILURE;
+
+		TileMapFixedBenchmarkAccess(&GetGameState()->MainTileMap, passes);
+		return COMMAND_SUCCESS;
+	};
+	ConsoleRegisterCommand(StringMake(SAllocatorArena(&GetGameState()->GameArena), "BenchTileAccess"), &cmd);
+
+	cmd.ArgumentString = StringMake(SAllocatorArena(&GetGameState()->GameArena), "<multiplier>");
+	cmd.OnCommand = [](const String cmd, const char** args, int argCount)
+	{
+		if (argCount <= 0)
+			return COMMAND_FAILURE;
+
+		float speed = (float)atof(args[1]);
+		if (speed <= 0.0f)
+			return COMMAND_FAILURE;
+
+		// Ticks per frame are capped so very high speeds will fall behind
+		GetGameState()->SimSpeed = speed;
+		SInfoLog("Simulation speed set to x%.2f", speed);
+		return COMMAND_SUCCESS;
+	};
+	ConsoleRegisterCommand(StringMake(SAllocatorArena(&GetGameState()->GameArena), "SimSpeed"), &cmd);
+
+	cmd.ArgumentString = StringMake(SAllocatorArena(&GetGameState()->GameArena), "");
+	cmd.OnCommand = [](const String cmd, const char** args, int argCount)
+	{
+		GeneralPurposeLogReport(&GetGameState()->GeneralPurposeMemory);
+		return COMMAND_SUCCESS;
+	};
+	ConsoleRegisterCommand(StringMake(SAllocatorArena(&GetGameState()->GameArena), "MemReport"), &cmd);
+
+	cmd.ArgumentString = StringMake(SAllocatorArena(&GetGameState()->GameArena), "[count]");
+	cmd.OnCommand = [](const String cmd, const char** args, int argCount)
+	{
+		int count = (argCount > 0) ? atoi(args[1]) : 16;
+		if (count <= 0)
+			return COMMAND_FAILURE;
+
+		LogMemoryCallsites(count);
+		return COMMAND_SUCCESS;
+	};
+	ConsoleRegisterCommand(StringMake(SAllocatorArena(&GetGameState()->GameArena), "MemCallsites"), &cmd);
+
+	cmd.ArgumentString = StringMake(SAllocatorArena(&GetGameState()->GameArena), "[path]");
+	cmd.OnCommand = [](const String cmd, const char** args, int argCount)
+	{
+		const char* path = (argCount > 0) ? args[1] : "memory_history.csv";
+		if (!MemoryHistoryWriteCsv(path))
+			return COMMAND_FAILURE;
+
+		SInfoLog("Wrote memory history to %s", path);
+		return COMMAND_SUCCESS;
+	};
+	ConsoleRegisterCommand(StringMake(SAllocatorArena(&GetGameState()->GameArena), "MemHistoryCsv"), &cmd);
+
+	cmd.ArgumentString = StringMake(SAllocatorArena(&GetGameState()->GameArena), "");
+	cmd.OnCommand = [](const String cmd, const char** args, int argCount)
+	{
+		LogScratchScopes();
+		return COMMAND_SUCCESS;
+	};
+	ConsoleRegisterCommand(StringMake(SAllocatorArena(&GetGameState()->GameArena), "MemScratch"), &cmd);
 }
 
 void ConsoleRegisterCommand(String cmdName, Command* cmd)
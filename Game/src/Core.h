@@ -64,11 +64,19 @@ constant_var int GAME_HEIGHT = 900;
 constant_var const char* TITLE = "Kingdoms";
 constant_var int MAX_FPS = 60;
 
+// Simulation runs at a fixed rate independent of rendering
+constant_var int TICKS_PER_SECOND = 30;
+constant_var float TICK_TIME = 1.0f / (float)TICKS_PER_SECOND;
+constant_var int MAX_TICKS_PER_FRAME = 16; // Extra backlog is dropped so slow ticks can't spiral
+
 constant_var int TILE_SIZE = 16;
 constant_var float INVERSE_TILE_SIZE = 1.0f / TILE_SIZE;
 constant_var float HALF_TILE_SIZE = TILE_SIZE / 2.0f;
 
 constant_var int CHUNK_SIZE = 32;
+constant_var int CHUNK_SIZE_SHIFT = 5;
+constant_var int CHUNK_SIZE_MASK = CHUNK_SIZE - 1;
+static_assert(CHUNK_SIZE == 1 << CHUNK_SIZE_SHIFT, "CHUNK_SIZE must be a power of 2");
 constant_var float INVERSE_CHUNK_SIZE = 1.0f / (float)CHUNK_SIZE;
 constant_var int CHUNK_SIZE_PIXELS = CHUNK_SIZE * TILE_SIZE;
 constant_var int CHUNK_SIZE_PIXELS_HALF = CHUNK_SIZE_PIXELS / 2;
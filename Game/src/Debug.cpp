@@ -82,19 +82,65 @@ void DrawDebugWindow(GameClient* client, GameState* gameState, GUIState* guiStat
 
 				nk_labelf(ctx, NK_TEXT_ALIGN_LEFT, "FPS: %d", GetFPS());
 				nk_labelf(ctx, NK_TEXT_ALIGN_LEFT, "UpdateTime: %.3fms", Client.UpdateTime * 1000.0);
+				nk_labelf(ctx, NK_TEXT_ALIGN_LEFT, "Ticks: %d/s (x%.2f), TickTime: %.3fms",
+						  gameState->TicksPerSecond, gameState->SimSpeed, gameState->TickTime * 1000.0);
 				nk_labelf(ctx, NK_TEXT_ALIGN_LEFT, "DrawTime: %.3fms", GetDrawTime() * 1000.0);
-				nk_labelf(ctx, NK_TEXT_ALIGN_LEFT, "GeneralPurpose: %dkb / %dkb",
+				GeneralPurposeStats gpaStats;
+				GeneralPurposeGetStats(&gameState->GeneralPurposeMemory, &gpaStats);
+				nk_labelf(ctx, NK_TEXT_ALIGN_LEFT, "GeneralPurpose: %dkb / %dkb committed (%dmb)",
 						  (int)((gameState->GeneralPurposeMemory.Size - GeneralPurposeGetFreeMemory(&gameState->GeneralPurposeMemory)) / 1024),
-						  (int)(gameState->GeneralPurposeMemory.Size / 1024));
-				nk_labelf(ctx, NK_TEXT_ALIGN_LEFT, "GameArena: %dkb / %dkb",
-						  (int)((gameState->GameArena.Size - ArenaSizeRemaining(&gameState->GameArena, 16)) / 1024),
-						  (int)(gameState->GameArena.Size / 1024));
-				nk_labelf(ctx, NK_TEXT_ALIGN_LEFT, "TempArena: %dkb / %dkb",
-						  (int)((TransientState.TransientArena.Size - ArenaSizeRemaining(&TransientState.TransientArena, 16)) / 1024),
-						  (int)(TransientState.TransientArena.Size / 1024));
+						  (int)(gpaStats.CommittedBytes / 1024),
+						  (int)(gameState->GeneralPurposeMemory.Size / Megabytes(1)));
+				nk_labelf(ctx, NK_TEXT_ALIGN_LEFT, "GameArena: %dkb / %dkb committed (%dmb)",
+						  (int)(gameState->GameArena.TotalAllocated / 1024),
+						  (int)(gameState->GameArena.Committed / 1024),
+						  (int)(gameState->GameArena.Size / Megabytes(1)));
+				nk_labelf(ctx, NK_TEXT_ALIGN_LEFT, "TempArena: %dkb / %dkb committed (%dmb)",
+						  (int)(TransientState.TransientArena.TotalAllocated / 1024),
+						  (int)(TransientState.TransientArena.Committed / 1024),
+						  (int)(TransientState.TransientArena.Size / Megabytes(1)));
 
 				nk_group_end(ctx);
 			}
+
+			//
+			// Memory History
+			//
+			nk_layout_space_push(ctx, nk_rect(width - 512 - 2, 259, 512, 224));
+			if (nk_group_begin(ctx, "MemoryHistory", NK_WINDOW_NO_SCROLLBAR))
+			{
+				const MemoryHistory* history = GetMemoryHistory();
+				u64 frames = Min(history->FrameCount, (u64)MEMORY_HISTORY_LENGTH);
+				if (frames > 0)
+				{
+					const MemoryFrameStats* last = &history->Frames[(history->FrameCount - 1) % MEMORY_HISTORY_LENGTH];
+
+					size_t transientPeak = 0;
+					for (u64 i = 0; i < frames; ++i)
+						transientPeak = Max(transientPeak, history->Frames[i].TransientHighWater);
+
+					nk_layout_row_static(ctx, TEXT_ROW_HEIGHT, 512, 1);
+					nk_labelf(ctx, NK_TEXT_ALIGN_LEFT, "Allocs: general %u, frame %u, malloc %u, arena %u",
+							  last->Allocs[(int)SAllocatorId::General], last->Allocs[(int)SAllocatorId::Frame],
+							  last->Allocs[(int)SAllocatorId::Malloc], last->Allocs[(int)SAllocatorId::Arena]);
+					nk_labelf(ctx, NK_TEXT_ALIGN_LEFT, "TempArena peak: %dkb, %dkb over %d frames, FrameArena peak: %dkb",
+							  (int)(last->TransientHighWater / 1024), (int)(transientPeak / 1024), (int)frames,
+							  (int)(last->FrameArenaHighWater / 1024));
+					nk_labelf(ctx, NK_TEXT_ALIGN_LEFT, "GameArena: %.2f%% of reserve, GeneralPurpose peak: %dkb",
+							  100.0 * (double)last->GameArenaUsed / (double)gameState->GameArena.Size,
+							  (int)(last->GeneralPurposeHighWater / 1024));
+
+					// Oldest to newest, TempArena peak per frame
+					nk_layout_row_static(ctx, 96, 500, 1);
+					if (nk_chart_begin(ctx, NK_CHART_LINES, (int)frames, 0.0f, (float)Max(transientPeak, (size_t)1)))
+					{
+						for (u64 frame = history->FrameCount - frames; frame < history->FrameCount; ++frame)
+							nk_chart_push(ctx, (float)history->Frames[frame % MEMORY_HISTORY_LENGTH].TransientHighWater);
+						nk_chart_end(ctx);
+					}
+				}
+				nk_group_end(ctx);
+			}
 			nk_layout_space_end(ctx);
 		}
 		nk_end(&guiState->Ctx);
@@ -10,6 +10,7 @@ ecs_entity_t SpawnCreature(GameState* gamestate, u16 type, Vec2i tile)
 
 	CTransform transform = {};
 	transform.Pos = TileToWorldCenter(tile);
+	transform.PrevPos = transform.Pos;
 	transform.TilePos = tile;
 	ecs_set_ex(world, entity, CTransform, transform);
 	
@@ -22,8 +23,7 @@ ecs_entity_t SpawnCreature(GameState* gamestate, u16 type, Vec2i tile)
 	render.Height = TILE_SIZE;
 	ecs_set_ex(world, entity, CRender, render);
 
-	Vec2i pos = Vec2i{ 0, 0 };
-	HashMapTSet(&gamestate->EntityMap, &pos, &entity);
+	SpatialGridAdd(&gamestate->EntityGrid, entity, tile);
 
 	return entity;
 }
@@ -35,7 +35,7 @@ void DestroyCreature(GameState* gamestate, ecs_entity_t entity)
 		const CTransform* transform = ecs_get(gamestate->World, entity, CTransform);
 		SAssert(transform);
 
-		HashMapTRemove(&gamestate->EntityMap, &transform->TilePos);
+		SpatialGridRemove(&gamestate->EntityGrid, entity, transform->TilePos);
 
 		ecs_delete(gamestate->World, entity);
 	}
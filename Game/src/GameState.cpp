@@ -9,9 +9,12 @@
 #include "RenderUtils.h"
 #include "Components.h"
 #include "Lighting.h"
+#include "Scratch.h"
 
 #include "Lib/Jobs.h"
 
+#include "Structures/SegmentedList.h"
+
 #include "raylib/src/rlgl.h"
 #include <raylib/src/raymath.h>
 
@@ -27,7 +30,6 @@ internal void UnloadAssets(GameState* gameState);
 internal void
 RescaleGUI(GameState* gameState, GUIState* guiState, GUIScale scale);
 
-ECS_SYSTEM_DECLARE(DrawEntities);
 
 // MAYBE_FIXME what to do about these allocators
 // raylib. I have to double check raylib allocations.
@@ -47,36 +49,124 @@ internal void RlFreeOverride(void* ptr)
 	return _aligned_free(ptr);
 }
 
-int
-GameInitialize()
+void
+GameInitializeMemory()
 {
-	size_t permanentMemorySize = Megabytes(16);
-	size_t gameMemorySize = Megabytes(16);
-	size_t frameMemorySize = Megabytes(16);
-	size_t totalMemory = permanentMemorySize + gameMemorySize + frameMemorySize;
-	zpl_virtual_memory vm = zpl_vm_alloc(0, totalMemory);
-	
-	uintptr_t memoryOffset = (uintptr_t)vm.data;
+	// Only address space is reserved, pages are committed as each one grows
+	size_t permanentMemorySize = Gigabytes(1);
+	size_t gameMemorySize = Gigabytes(1);
+	size_t frameMemorySize = Megabytes(256);
+	size_t twoFrameMemorySize = Megabytes(64);
+
+	ArenaCreateVirtual(&State.GameArena, permanentMemorySize, false);
+	GeneralPurposeCreateVirtual(&State.GeneralPurposeMemory, gameMemorySize);
+	// Frame memory rewinds every frame, spikes like world generation are given back
+	ArenaCreateVirtual(&TransientState.TransientArena, frameMemorySize, true);
+	ArenaCreateVirtual(&TransientState.FrameArenas.Arenas[0], twoFrameMemorySize, true);
+	ArenaCreateVirtual(&TransientState.FrameArenas.Arenas[1], twoFrameMemorySize, true);
+	zpl_mutex_init(&TransientState.FrameArenas.Lock);
 
-	ArenaCreate(&State.GameArena, (void*)memoryOffset, permanentMemorySize);
-	memoryOffset += permanentMemorySize;
+	InitializeMemoryTracking();
 
-	GeneralPurposeCreate(&State.GeneralPurposeMemory, (void*)memoryOffset, gameMemorySize);
-	memoryOffset += gameMemorySize;
+	PushMemoryIgnoreFree();
+	JobsInitialize(7);
+	PopMemoryIgnoreFree();
 
-	ArenaCreate(&TransientState.TransientArena, (void*)memoryOffset, frameMemorySize);
-	memoryOffset += frameMemorySize;
+	// Workers give back their cached slab objects and cache slot
+	JobsSetThreadExitCallback([]()
+		{
+			GeneralPurposeFlushThreadCache(&State.GeneralPurposeMemory);
+			GeneralPurposeReleaseThreadSlot();
+		});
+}
 
-	SAssert(memoryOffset - vm.size == (size_t)vm.data);
+// Everything the simulation needs, nothing here may touch the window or GPU
+void
+GameInitializeWorld(int mapLengthInChunks)
+{
+	PushMemoryIgnoreFree();
 
-	InitializeMemoryTracking();
+	State.SimSpeed = 1.0f;
+
+	TileMgrInitialize(&State.AssetMgr.TileSpriteSheet);
+
+	//TileMapInit(&State, &State.TileMap, { -8, -8, 8, 8 });
+	TileMapFixedCreate(&State.MainTileMap, mapLengthInChunks, 0);
+	SpatialGridCreate(&State.EntityGrid, SAllocatorGeneral(), State.MainTileMap.LengthInChunks);
+
+	// Entities
+	State.World = ecs_init();
+
+	ECS_COMPONENT_DEFINE(State.World, CTransform);
+	ECS_COMPONENT_DEFINE(State.World, CRender);
+	ECS_COMPONENT_DEFINE(State.World, CMove);
+
+	ECS_TAG_DEFINE(State.World, GameObject);
+
+	//ECS_OBSERVER(State.World, MoveOnAdd, EcsOnAdd, CMove);
+	//ECS_OBSERVER(State.World, MoveOnRemove, EcsOnRemove, CMove);
+
+	ECS_SYSTEM(State.World, TransformSnapshotSystem, EcsPreUpdate, CTransform);
+	ECS_SYSTEM(State.World, MoveSystem, EcsOnUpdate, CTransform, CMove);
+
+	PoolConcurrentCreate(&State.PathNodePool, SAllocatorGeneral(), sizeof(Node), 2048);
+	PoolConcurrentCreate(&State.RegionNodePool, SAllocatorGeneral(), sizeof(RegionNode), 512);
+	PathfinderInit(&State.Pathfinder);
+	PathfinderRegionsInit(&State.RegionPathfinder);
+
+	PopMemoryIgnoreFree();
+}
+
+void
+GameShutdownWorld()
+{
+	ecs_fini(State.World);
+
+	SpatialGridDestroy(&State.EntityGrid);
+
+	// Destroying the pools frees every node
+	PoolConcurrentDestroy(&State.PathNodePool);
+	PoolConcurrentDestroy(&State.RegionNodePool);
+	State.Pathfinder.Nodes = nullptr;
+	State.RegionPathfinder.Nodes = nullptr;
+
+	//TileMapFree(&State.TileMap);
+	TileMapFixedUnload(&State.MainTileMap, &State);
+}
+
+void
+GameRunSelfTests()
+{
+	TestSpareSet();
+	TestChunkTexturePool();
+	TestSpriteBatch();
+	TestSpatialGrid();
+	TestTileEditBatch();
+	TestHashMapSwiss();
+	TestHashMapT();
+	TestHashSetT();
+	TestTwoFrameAllocator();
+	TestScratchScope();
+	TestSegmentedList();
+}
+
+void
+GameRunThreadedSelfTests()
+{
+	TestGeneralPurposeAllocator();
+	TestPoolConcurrent();
+	TestMemoryTrackingThreaded();
+}
+
+int
+GameInitialize()
+{
+	GameInitializeMemory();
 
 	ArenaSnapshot tempMemoryInit = ArenaSnapshotBegin(&TransientState.TransientArena);
 
 	PushMemoryIgnoreFree();
 
-	JobsInitialize(7);
-
 	ConsoleInit();
 
 	SetMallocCallBack(RlMallocOverride);
@@ -103,39 +193,20 @@ GameInitialize()
 	bool guiInitialized = InitializeGUI(&State, &State.AssetMgr.MainFont);
 	SAssert(guiInitialized);
 
-	HashMapTInitialize(&State.EntityMap, 4096, SAllocatorArena(&GetGameState()->GameArena));
-
-	TileMgrInitialize(&State.AssetMgr.TileSpriteSheet);
-
-	//TileMapInit(&State, &State.TileMap, { -8, -8, 8, 8 });
-	TileMapFixedCreate(&State.MainTileMap, 4, 0);
+	SpriteBatchInitialize(&State.DrawBatch, SAllocatorGeneral(), CHUNK_AREA * 2);
 
-	// Entities
-	State.World = ecs_init();
-
-	ECS_COMPONENT_DEFINE(State.World, CTransform);
-	ECS_COMPONENT_DEFINE(State.World, CRender);
-	ECS_COMPONENT_DEFINE(State.World, CMove);
-
-	ECS_TAG_DEFINE(State.World, GameObject);
-
-	//ECS_OBSERVER(State.World, MoveOnAdd, EcsOnAdd, CMove);
-	//ECS_OBSERVER(State.World, MoveOnRemove, EcsOnRemove, CMove);
-
-	ECS_SYSTEM_DEFINE(State.World, DrawEntities, 0, CTransform, CRender);
-	ECS_SYSTEM(State.World, MoveSystem, EcsOnUpdate, CTransform, CMove);
+	GameInitializeWorld(4);
 
 	Client.Player = SpawnCreature(&State, 0, { 0, 0 });
 
-	PathfinderInit(&State.Pathfinder);
-	PathfinderRegionsInit(&State.RegionPathfinder);
-
 	Client.IsDebugMode = true;
 
 	if (Client.IsDebugMode)
 		SInfoLog("[ Game ] Running in DEBUG mode!");
 
-	TestSpareSet();
+#if SCAL_DEBUG
+	GameRunSelfTests();
+#endif
 
 	PopMemoryIgnoreFree();
 
@@ -183,8 +254,30 @@ GameRun()
 
 		if (!State.IsGamePaused)
 		{
+			double tickStart = GetTime();
+
+			State.TickAccumulator += (double)DeltaTime * State.SimSpeed;
+			int ticks = 0;
+			while (State.TickAccumulator >= TICK_TIME && ticks < MAX_TICKS_PER_FRAME)
+			{
+				GameTick();
+				State.TickAccumulator -= TICK_TIME;
+				++ticks;
+			}
+			if (ticks == MAX_TICKS_PER_FRAME)
+				State.TickAccumulator = Min(State.TickAccumulator, (double)TICK_TIME);
+
+			State.TickAlpha = (float)(State.TickAccumulator / TICK_TIME);
+			State.TickTime = GetTime() - tickStart;
+
 			GameUpdate();
-			ecs_progress(State.World, DeltaTime);
+		}
+
+		if (start - State.TicksSecondStart >= 1.0)
+		{
+			State.TicksPerSecond = State.TicksThisSecond;
+			State.TicksThisSecond = 0;
+			State.TicksSecondStart = start;
 		}
 
 		DrawErrorPopupWindow(&State);
@@ -197,6 +290,8 @@ GameRun()
 		screenRect.width = (float)GetScreenWidth() / State.Camera.zoom;
 		screenRect.height = (float)GetScreenHeight() / State.Camera.zoom;
 
+		TileMapFixedUpdateTextures(&State.MainTileMap, screenRect);
+
 		BeginTextureMode(State.ScreenTexture);
 		BeginMode2D(State.Camera);
 		ClearBackground(BLACK);
@@ -204,7 +299,8 @@ GameRun()
 		//TileMapDraw(&State.TileMap, screenRect);
 		TileMapFixedDraw(&State.MainTileMap, screenRect);
 
-		ecs_run(State.World, ecs_id(DrawEntities), DeltaTime, NULL);
+		DrawEntities(&State, screenRect);
+		SpriteBatchFlush(&State.DrawBatch);
 
 		GameLateUpdate();
 
@@ -241,14 +337,28 @@ GameRun()
 		EndDrawing();
 
 		ArenaSnapshotEnd(tempMemory);
+		MemoryEndFrame();
 	}
 }
 
+// Once per rendered frame
 void GameUpdate()
 {
+	LightMapUpdate(&State);
+}
+
+// Fixed rate simulation step
+void GameTick()
+{
+	double timerStart = SystemTimerBegin();
 	//TileMapUpdate(&State, &State.TileMap);
 	TileMapFixedUpdate(&State.MainTileMap, &State);
-	LightMapUpdate(&State);
+	SystemTimerEnd(SYSTEM_TIMER_TILEMAP, timerStart);
+
+	ecs_progress(State.World, TICK_TIME);
+
+	++State.TickCount;
+	++State.TicksThisSecond;
 }
 
 void GameLateUpdate()
@@ -336,11 +446,11 @@ void InputUpdate()
 	{
 		Vec2i tile = ScreenToTile();
 
-		ecs_entity_t* entity = HashMapTGet(&State.EntityMap, &tile);
+		ecs_entity_t entity = SpatialGridFirstAt(&State.EntityGrid, tile);
 		if (entity)
 		{
-			Client.SelectedEntity = *entity;
-			const char* entityInfo = ecs_entity_str(State.World, *entity);
+			Client.SelectedEntity = entity;
+			const char* entityInfo = ecs_entity_str(State.World, entity);
 			SInfoLog("%s", entityInfo);
 		}
 	}
@@ -373,15 +483,10 @@ void InputUpdate()
 void
 GameShutdown()
 {
-	ecs_fini(State.World);
-
-	//HashMapTDestroy(&State.EntityMap);
+	GameShutdownWorld();
 
 	UnloadRenderTexture(State.ScreenTexture);
 
-	//TileMapFree(&State.TileMap);
-	TileMapFixedUnload(&State.MainTileMap, &State);
-
 	UnloadAssets(&State);
 
 	CloseWindow();
@@ -561,10 +666,8 @@ bool Container::Contains(u16 itemId, i16 amount)
 
 void TileMapUpdateZoneId(TileMapFixed* tilemap)
 {
-	ArenaSnapshot snapshot = ArenaSnapshotBegin(&TransientState.TransientArena);
+	ScratchScope scratch("TileMapUpdateZoneId");
 
 	HashSetT<Vec2i> TilesChecked = {};
-	TilesChecked.Alloc = SAllocatorArena(snapshot.Arena);
-
-	ArenaSnapshotEnd(snapshot);
+	TilesChecked.Alloc = scratch.Allocator();
 }
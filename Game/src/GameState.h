@@ -11,6 +11,8 @@
 #include "GameTypes.h"
 #include "Components.h"
 #include "Entity.h"
+#include "SpriteBatch.h"
+#include "SpatialGrid.h"
 
 #include "Structures/SList.h"
 #include "Structures/ArrayList.h"
@@ -64,19 +66,43 @@ struct GameState
 
 	ecs_world_t* World;
 
-	HashMapT<Vec2i, ecs_entity_t> EntityMap;
+	SpatialGrid EntityGrid; // Entities by TilePos, one cell per chunk
 
 	ActionMgr ActionMgr;
 
+	SpriteBatch DrawBatch; // Shared by entity drawing and chunk baking, empty between uses
+
 	Pathfinder Pathfinder;
 	RegionPathfinder RegionPathfinder;
+	PoolConcurrent PathNodePool;   // Node for every Pathfinder, jobs included
+	PoolConcurrent RegionNodePool; // RegionNode for every RegionPathfinder
+
+	// Fixed timestep
+	double TickAccumulator; // Unsimulated time in seconds, already scaled by SimSpeed
+	double TickTime; // Time spent ticking last frame, in seconds
+	double TicksSecondStart;
+	u64 TickCount;
+	float SimSpeed; // 1 is real time
+	float TickAlpha; // Rendering position between the previous and current tick
+	int TicksThisSecond;
+	int TicksPerSecond; // Measured over the last real second
 
 	bool IsGamePaused;
 };
 
+// Memory for results handed to the next frame, like those of jobs started
+// this frame. Arenas[Index] takes pushes, the other holds the last frame's.
+struct TwoFrameArenas
+{
+	Arena Arenas[2];
+	u32 Index;
+	zpl_mutex Lock; // Pushes come from jobs too
+};
+
 struct TransientGameState
 {
 	Arena TransientArena;
+	TwoFrameArenas FrameArenas; // MemoryEndFrame swaps them and clears the one taking pushes
 };
 
 struct GameClient
@@ -126,6 +152,17 @@ void ItemStackHolderRemove(ItemStackHolder* holder, CItemStack* stack);
 int ItemStackHolderFind(ItemStackHolder* holder, u16 itemId);
 void ItemStackHolderFill(ItemStackHolder* holder, u16 itemId, ArrayList(ecs_entity_t) inItemStacks);
 
+// Shared by the windowed game and the headless build
+void GameInitializeMemory();
+void GameInitializeWorld(int mapLengthInChunks);
+void GameShutdownWorld();
+void GameTick();
+
+// Debug builds run these at startup, add new tests here instead of to GameInitialize
+void GameRunSelfTests();
+// These dispatch jobs and reserve address space, only GameHeadless selftest runs them
+void GameRunThreadedSelfTests();
+
 ecs_entity_t SpawnCreature(GameState* gamestate, u16 type, Vec2i tile);
 
 void DestroyCreature(GameState* gamestate, ecs_entity_t entity);
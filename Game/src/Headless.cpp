@@ -0,0 +1,196 @@
+#include "GameState.h"
+
+#include "Systems.h"
+#include "Components.h"
+#include "Regions.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Entry point of the GameHeadless target (SCAL_HEADLESS). Runs the simulation
+// without a window so large colonies can be benchmarked on machines without a GPU.
+//
+// Usage: GameHeadless [ticks] [population] [mapLengthInChunks] [seed] [memoryCsv]
+//        GameHeadless selftest
+//
+// memoryCsv writes per tick memory use of the last MEMORY_HISTORY_LENGTH ticks.
+// selftest runs the tests too heavy for startup, it only asserts in debug builds.
+
+constant_var int HEADLESS_DEFAULT_TICKS = 1000;
+constant_var int HEADLESS_DEFAULT_POPULATION = 1000;
+constant_var int HEADLESS_DEFAULT_MAP_LENGTH = 8;
+
+internal Vec2i
+InternalRandomOpenTile(SRandom* random, int tileLength)
+{
+	// Gives up and returns the last roll on maps that are mostly solid
+	Vec2i tile = {};
+	for (int attempt = 0; attempt < 64; ++attempt)
+	{
+		tile.x = (int)SRandNextRange(random, 0, tileLength - 1);
+		tile.y = (int)SRandNextRange(random, 0, tileLength - 1);
+		if (!FixedChunkIsTileSolid(&State.MainTileMap, tile))
+			break;
+	}
+	return tile;
+}
+
+struct HeadlessScript
+{
+	SRandom Random;
+	int TileLength;
+};
+
+// Idle creatures wander to a random tile, same as MoveEntity without the debug timer
+internal void
+HeadlessWanderSystem(ecs_iter_t* it)
+{
+	CTransform* transforms = ecs_field(it, CTransform, 1);
+	CMove* moves = ecs_field(it, CMove, 2);
+	HeadlessScript* script = (HeadlessScript*)it->param;
+
+	for (int i = 0; i < it->count; ++i)
+	{
+		if (!moves[i].IsCompleted)
+			continue;
+
+		moves[i].Start = transforms[i].Pos;
+		moves[i].Target = {};
+		moves[i].Progress = 0;
+		moves[i].IsCompleted = false;
+		Vec2i target = InternalRandomOpenTile(&script->Random, script->TileLength);
+		PathfindRegion(transforms[i].TilePos, target, &moves[i].MoveData);
+	}
+}
+
+internal void
+InternalReportMemory()
+{
+	size_t gpaUsed = State.GeneralPurposeMemory.Size - GeneralPurposeGetFreeMemory(&State.GeneralPurposeMemory);
+	size_t arenaUsed = State.GameArena.Size - ArenaSizeRemaining(&State.GameArena, 16);
+	printf("memory.general_purpose_kb=%d/%d\n", (int)(gpaUsed / 1024), (int)(State.GeneralPurposeMemory.Size / 1024));
+	printf("memory.game_arena_kb=%d/%d\n", (int)(arenaUsed / 1024), (int)(State.GameArena.Size / 1024));
+
+	GeneralPurposeStats gpaStats;
+	GeneralPurposeGetStats(&State.GeneralPurposeMemory, &gpaStats);
+	printf("memory.slab_used_kb=%d\n", (int)(gpaStats.SlabUsedBytes / 1024));
+	printf("memory.slab_waste_kb=%d\n", (int)(gpaStats.SlabWasteBytes / 1024));
+	printf("memory.large_free_kb=%d\n", (int)(gpaStats.LargeFreeBytes / 1024));
+	printf("memory.large_free_nodes=%d\n", (int)gpaStats.LargeFreeNodes);
+	printf("memory.general_purpose_committed_kb=%d\n", (int)(gpaStats.CommittedBytes / 1024));
+	printf("memory.game_arena_committed_kb=%d\n", (int)(State.GameArena.Committed / 1024));
+	printf("memory.transient_arena_committed_kb=%d\n", (int)(TransientState.TransientArena.Committed / 1024));
+
+	// Over the ticks still in the history
+	const MemoryHistory* history = GetMemoryHistory();
+	u64 frames = Min(history->FrameCount, (u64)MEMORY_HISTORY_LENGTH);
+	size_t transientPeak = 0;
+	size_t frameArenaPeak = 0;
+	u64 generalAllocs = 0;
+	for (u64 i = 0; i < frames; ++i)
+	{
+		transientPeak = Max(transientPeak, history->Frames[i].TransientHighWater);
+		frameArenaPeak = Max(frameArenaPeak, history->Frames[i].FrameArenaHighWater);
+		generalAllocs += history->Frames[i].Allocs[(int)SAllocatorId::General];
+	}
+	printf("memory.transient_peak_kb=%d\n", (int)(transientPeak / 1024));
+	printf("memory.frame_arena_peak_kb=%d\n", (int)(frameArenaPeak / 1024));
+	printf("memory.general_allocs_per_tick=%.1f\n", (frames) ? (double)generalAllocs / (double)frames : 0.0);
+}
+
+int
+HeadlessMain(int argCount, char** args)
+{
+	if (argCount > 1 && strcmp(args[1], "selftest") == 0)
+	{
+		GameInitializeMemory();
+		GameRunThreadedSelfTests();
+		ShutdownMemoryTracking();
+#if SCAL_DEBUG
+		// A failed SAssert breaks before this
+		printf("selftest=passed\n");
+#else
+		printf("selftest=skipped (release build)\n");
+#endif
+		return 0;
+	}
+
+	int ticks = (argCount > 1) ? atoi(args[1]) : HEADLESS_DEFAULT_TICKS;
+	int population = (argCount > 2) ? atoi(args[2]) : HEADLESS_DEFAULT_POPULATION;
+	int mapLength = (argCount > 3) ? atoi(args[3]) : HEADLESS_DEFAULT_MAP_LENGTH;
+	u64 seed = (argCount > 4) ? (u64)atoll(args[4]) : 0;
+	const char* memoryCsvPath = (argCount > 5) ? args[5] : nullptr;
+	if (ticks <= 0 || population < 0 || mapLength <= 0)
+	{
+		printf("Usage: GameHeadless [ticks] [population] [mapLengthInChunks] [seed] [memoryCsv]\n");
+		printf("       GameHeadless selftest\n");
+		return 1;
+	}
+
+	SetTraceLogLevel(LOG_WARNING);
+
+	GameInitializeMemory();
+	GameInitializeWorld(mapLength);
+
+	// First tick loads regions, creatures can't path before that
+	GameTick();
+
+	HeadlessScript script;
+	SRandomInitialize(&script.Random, seed);
+	script.TileLength = mapLength * CHUNK_SIZE;
+
+	// Not in a phase, ran before each tick
+	ECS_SYSTEM(State.World, HeadlessWanderSystem, 0, CTransform, CMove);
+
+	for (int i = 0; i < population; ++i)
+	{
+		SpawnCreature(&State, 0, InternalRandomOpenTile(&script.Random, script.TileLength));
+	}
+
+	for (int i = 0; i < SYSTEM_TIMER_COUNT; ++i)
+	{
+		SystemTimers[i].Seconds = 0;
+		SystemTimers[i].Calls = 0;
+	}
+
+	double scriptSeconds = 0;
+	double start = zpl_time_rel();
+	for (int i = 0; i < ticks; ++i)
+	{
+		ArenaSnapshot tempMemory = ArenaSnapshotBegin(&TransientState.TransientArena);
+
+		double scriptStart = zpl_time_rel();
+		ecs_run(State.World, ecs_id(HeadlessWanderSystem), TICK_TIME, &script);
+		scriptSeconds += zpl_time_rel() - scriptStart;
+
+		GameTick();
+
+		ArenaSnapshotEnd(tempMemory);
+		MemoryEndFrame();
+	}
+	double elapsed = zpl_time_rel() - start;
+
+	printf("ticks=%d\n", ticks);
+	printf("population=%d\n", population);
+	printf("map_length_chunks=%d\n", mapLength);
+	printf("seconds=%.4f\n", elapsed);
+	printf("ticks_per_second=%.2f\n", (double)ticks / elapsed);
+	printf("realtime_multiplier=%.2f\n", ((double)ticks * TICK_TIME) / elapsed);
+	printf("system.Pathfinding.ms_per_tick=%.4f\n", scriptSeconds * 1000.0 / ticks);
+	for (int i = 0; i < SYSTEM_TIMER_COUNT; ++i)
+	{
+		printf("system.%s.ms_per_tick=%.4f\n", SystemTimers[i].Name, SystemTimers[i].Seconds * 1000.0 / ticks);
+	}
+	InternalReportMemory();
+
+	if (memoryCsvPath && MemoryHistoryWriteCsv(memoryCsvPath))
+	{
+		printf("memory.csv=%s\n", memoryCsvPath);
+	}
+
+	GameShutdownWorld();
+	ShutdownMemoryTracking();
+
+	return 0;
+}
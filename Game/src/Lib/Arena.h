@@ -2,13 +2,23 @@
 
 #include "Base.h"
 #include "Memory.h"
+#include "VirtualMemory.h"
 
+// Snapshot rewinds keep this much committed above what's in use so an arena
+// reset every frame doesn't commit and decommit every frame
+constant_var size_t ARENA_DECOMMIT_KEEP = Megabytes(16);
+
+// Virtual arenas reserve Size up front and commit pages as pushes reach them
 struct Arena
 {
 	void* Memory;
 	size_t Size;
 	size_t TotalAllocated;
+	size_t Committed;
+	size_t HighWater; // Most TotalAllocated has been since the last ArenaResetHighWater
 	int TempCount;
+	bool IsVirtual;
+	bool DecommitOnRewind;
 	SAllocator Allocator;
 };
 
@@ -21,6 +31,9 @@ inline void ArenaCreateFromAllocator(Arena* arena, SAllocator backing, size_t si
 //! Initialize memory arena within an existing parent memory arena.
 inline void ArenaCreateFromArena(Arena* arena, Arena* parent_arena, size_t size);
 
+//! Initialize memory arena reserving address space, committed as it's used.
+inline void ArenaCreateVirtual(Arena* arena, size_t reserveSize, bool decommitOnRewind);
+
 //! Release the memory used by memory arena.
 inline void ArenaFree(Arena* arena);
 
@@ -42,6 +55,18 @@ inline ArenaSnapshot ArenaSnapshotBegin(Arena* arena);
 //! Reset memory arena's usage by a captured snapshot.
 inline void ArenaSnapshotEnd(ArenaSnapshot snapshot);
 
+//! Free everything pushed to a memory arena.
+inline void ArenaClear(Arena* arena);
+
+//! Commit pages of a virtual arena up to size bytes.
+inline bool ArenaCommit(Arena* arena, size_t size);
+
+//! Start tracking the high water mark from current usage.
+inline void ArenaResetHighWater(Arena* arena);
+
+//! Decommit pages of a virtual arena above keepSize, rounded up to used memory.
+inline void ArenaDecommit(Arena* arena, size_t keepSize);
+
 inline void* ArenaPush(Arena* arena, size_t size);
 inline void* ArenaPushZero(Arena* arena, size_t size);
 
@@ -61,7 +86,11 @@ void ArenaCreate(Arena* arena, void* start, size_t size)
 	arena->Memory = start;
 	arena->Size = size;
 	arena->TotalAllocated = 0;
+	arena->Committed = size;
+	arena->HighWater = 0;
 	arena->TempCount = 0;
+	arena->IsVirtual = false;
+	arena->DecommitOnRewind = false;
 }
 
 //! Initialize memory arena using existing memory SAllocator.
@@ -71,7 +100,11 @@ void ArenaCreateFromAllocator(Arena* arena, SAllocator backing, size_t size)
 	arena->Memory = SAlloc(backing, size);
 	arena->Size = size;
 	arena->TotalAllocated = 0;
+	arena->Committed = size;
+	arena->HighWater = 0;
 	arena->TempCount = 0;
+	arena->IsVirtual = false;
+	arena->DecommitOnRewind = false;
 }
 
 //! Initialize memory arena within an existing parent memory arena.
@@ -80,10 +113,36 @@ void ArenaCreateFromArena(Arena* arena, Arena* parentArena, size_t size)
 	ArenaCreateFromAllocator(arena, SAllocatorArena(parentArena), size);
 }
 
+//! Initialize memory arena reserving address space, committed as it's used.
+void ArenaCreateVirtual(Arena* arena, size_t reserveSize, bool decommitOnRewind)
+{
+	size_t size = AlignSize(reserveSize, VIRTUAL_MEMORY_COMMIT_SIZE);
+	arena->Allocator = {};
+	arena->Memory = VirtualMemoryReserve(size);
+	arena->Size = (arena->Memory) ? size : 0;
+	arena->TotalAllocated = 0;
+	arena->Committed = 0;
+	arena->HighWater = 0;
+	arena->TempCount = 0;
+	arena->IsVirtual = true;
+	arena->DecommitOnRewind = decommitOnRewind;
+	if (!arena->Memory)
+	{
+		SError("Arena failed to reserve %zu bytes", size);
+	}
+}
+
 //! Release the memory used by memory arena.
 void ArenaFree(Arena* arena)
 {
-	if (IsAllocatorValid(arena->Allocator))
+	if (arena->IsVirtual)
+	{
+		if (arena->Memory)
+			VirtualMemoryRelease(arena->Memory, arena->Size);
+		arena->Memory = nullptr;
+		arena->Committed = 0;
+	}
+	else if (IsAllocatorValid(arena->Allocator))
 	{
 		SFree(arena->Allocator, arena->Memory);
 		arena->Memory = nullptr;
@@ -127,6 +186,50 @@ void ArenaSnapshotEnd(ArenaSnapshot snapshot)
 	SAssert(snapshot.Arena->TempCount > 0);
 	snapshot.Arena->TotalAllocated = snapshot.OriginalTotalAllocated;
 	snapshot.Arena->TempCount--;
+
+	if (snapshot.Arena->DecommitOnRewind)
+		ArenaDecommit(snapshot.Arena, ARENA_DECOMMIT_KEEP);
+}
+
+//! Free everything pushed to a memory arena.
+void ArenaClear(Arena* arena)
+{
+	SAssert(arena->TempCount == 0);
+	arena->TotalAllocated = 0;
+
+	if (arena->DecommitOnRewind)
+		ArenaDecommit(arena, ARENA_DECOMMIT_KEEP);
+}
+
+//! Commit pages of a virtual arena up to size bytes.
+bool ArenaCommit(Arena* arena, size_t size)
+{
+	if (size <= arena->Committed)
+		return true;
+
+	if (!arena->IsVirtual || size > arena->Size)
+		return false;
+
+	size_t commit = Min(AlignSize(size, VIRTUAL_MEMORY_COMMIT_SIZE), arena->Size);
+	if (!VirtualMemoryCommit((u8*)arena->Memory + arena->Committed, commit - arena->Committed))
+		return false;
+
+	arena->Committed = commit;
+	return true;
+}
+
+//! Decommit pages of a virtual arena above keepSize, rounded up to used memory.
+void ArenaDecommit(Arena* arena, size_t keepSize)
+{
+	if (!arena->IsVirtual)
+		return;
+
+	size_t keep = AlignSize(arena->TotalAllocated + keepSize, VIRTUAL_MEMORY_COMMIT_SIZE);
+	if (keep >= arena->Committed)
+		return;
+
+	VirtualMemoryDecommit((u8*)arena->Memory + keep, arena->Committed - keep);
+	arena->Committed = keep;
 }
 
 void* ArenaPush(Arena* arena, size_t size)
@@ -134,7 +237,8 @@ void* ArenaPush(Arena* arena, size_t size)
 	void* res;
 	size_t totalSize = AlignSize(size, 16);
 
-	if (arena->TotalAllocated + totalSize > arena->Size)
+	if (arena->TotalAllocated + totalSize > arena->Committed
+		&& !ArenaCommit(arena, arena->TotalAllocated + totalSize))
 	{
 		SError("Arena out of memory");
 		return nullptr;
@@ -142,10 +246,17 @@ void* ArenaPush(Arena* arena, size_t size)
 
 	res = (void*)((size_t)arena->Memory + arena->TotalAllocated);
 	arena->TotalAllocated += totalSize;
+	arena->HighWater = Max(arena->HighWater, arena->TotalAllocated);
 	SAssert(res);
 	return res;
 }
 
+//! Start tracking the high water mark from current usage.
+void ArenaResetHighWater(Arena* arena)
+{
+	arena->HighWater = arena->TotalAllocated;
+}
+
 void* ArenaPushZero(Arena* arena, size_t size)
 {
 	void* res = ArenaPush(arena, size);
@@ -1,235 +1,383 @@
 #include "GeneralAllocator.h"
 
 #include "Core.h"
+#include "Jobs.h"
+#include "VirtualMemory.h"
 
 #include <stdlib.h>
 
-constant_var size_t GENERALPURPOSE_BUCKET_SIZES[GENERALPURPOSE_BUCKET_SIZE] =
+constant_var size_t GENERALPURPOSE_ALIGNMENT = 16;
+
+constant_var size_t MEMNODE_FREE = 1;
+constant_var size_t MEMNODE_PREV_FREE = 2;
+constant_var size_t MEMNODE_FLAGS = MEMNODE_FREE | MEMNODE_PREV_FREE;
+constant_var size_t MEMNODE_HEADER_SIZE = offsetof(MemNode, Next);
+constant_var size_t MEMNODE_MIN_SIZE = sizeof(MemNode);
+// Leftovers smaller than this stay part of the allocation
+constant_var size_t MEMNODE_SPLIT_THRESHOLD = 256;
+
+static_assert(MEMNODE_HEADER_SIZE % GENERALPURPOSE_ALIGNMENT == 0, "Allocations wouldn't be aligned");
+static_assert(MEMNODE_MIN_SIZE % GENERALPURPOSE_ALIGNMENT == 0);
+
+constant_var size_t GENERALPURPOSE_SLAB_SIZES[GENERALPURPOSE_SLAB_CLASS_COUNT] =
 {
-	512, 1024, 2048, 4096, 8192, 16384
+	16, 32, 48, 64, 96, 128, 192, 256
 };
-constant_var size_t GENERALPURPOSE_ALIGNMENT = GENERALPURPOSE_BUCKET_SIZES[0];
-constant_var size_t MEM_SPLIT_THRESHOLD = GENERALPURPOSE_BUCKET_SIZES[GENERALPURPOSE_BUCKET_SIZE - 1] << 1;
 
-static_assert(AlignPowTwo64Ceil(AlignSize(1200, GENERALPURPOSE_BUCKET_SIZES[0])) == 2048);
-static_assert(ArrayLength(GENERALPURPOSE_BUCKET_SIZES) == GENERALPURPOSE_BUCKET_SIZE, "GENERALPURPOSE_BUCKET_SIZES count is not FREELIST_BUCKET_SIZE");
-
-// Power of 2 to array index
-internal _FORCE_INLINE_
-u32 ConvertAllocSizeToIndex(size_t allocSize)
+// (size + 15) / 16 to the smallest class that fits
+constant_var u8 GENERALPURPOSE_SLAB_CLASS_LOOKUP[GENERALPURPOSE_SLAB_MAX_SIZE / 16 + 1] =
 {
-	SAssert(allocSize >= GENERALPURPOSE_BUCKET_SIZES[0]);
-	SAssert(allocSize <= GENERALPURPOSE_BUCKET_SIZES[GENERALPURPOSE_BUCKET_SIZE - 1]);
-	size_t allocSizeBucketIndex = allocSize / GENERALPURPOSE_BUCKET_SIZES[0];
-	SAssert(allocSizeBucketIndex < GENERALPURPOSE_BUCKET_SIZES[GENERALPURPOSE_BUCKET_SIZE - 1] / allocSizeBucketIndex);
+	0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7
+};
+
+constant_var size_t GENERALPURPOSE_SLAB_HEADER_SIZE = AlignSize(sizeof(SlabPage), 16);
 
-	unsigned long index = 0;
+static_assert(GENERALPURPOSE_SLAB_SIZES[GENERALPURPOSE_SLAB_CLASS_COUNT - 1] == GENERALPURPOSE_SLAB_MAX_SIZE);
+static_assert((GENERALPURPOSE_SLAB_PAGE_SIZE - GENERALPURPOSE_SLAB_HEADER_SIZE) / GENERALPURPOSE_SLAB_SIZES[0] <= GENERALPURPOSE_SLAB_BITMAP_WORDS * 64,
+			  "Slab bitmap can't fit the smallest class");
+
+internal _FORCE_INLINE_ u32
+FindFirstSet(u64 mask)
+{
+	SAssert(mask);
 #if _WIN32
-	_BitScanForward(&index, (unsigned long)allocSizeBucketIndex);
+	unsigned long index;
+	_BitScanForward64(&index, mask);
+	return (u32)index;
 #else
-	// TODO gcc has __builtin_clz maybe look into.
-
-	while (powOf2 > 0)
-	{           // until all bits are zero
-		if ((powOf2 & 1) == 1)     // check lower bit
-			++index;
-		powOf2 >>= 1;              // shift bits, removing lower bit
-	}
+	return (u32)__builtin_ctzll(mask);
 #endif
-	return (u32)index;
 }
 
-// 65536, 32768 16384, 8192 4096 2048 1024
-// 256, 512, 1024, 2048
+internal _FORCE_INLINE_ bool
+IsSlabPointer(GeneralPurposeAllocator* allocator, void* ptr)
+{
+	return (uintptr_t)ptr >= allocator->SlabBase && (uintptr_t)ptr < allocator->SlabTop;
+}
 
-internal MemNode*
-SplitMemNode(MemNode* node, size_t bytes)
+internal _FORCE_INLINE_ SlabPage*
+SlabPageFromPointer(GeneralPurposeAllocator* allocator, void* ptr)
 {
-	uintptr_t n = (uintptr_t)node;
-	MemNode* r = (MemNode*)(n + (node->Size - bytes));
-	node->Size -= bytes;
-	r->Size = bytes;
+	uintptr_t offset = (uintptr_t)ptr - allocator->SlabBase;
+	return (SlabPage*)(allocator->SlabBase + (offset - offset % GENERALPURPOSE_SLAB_PAGE_SIZE));
+}
 
-	return r;
+internal void
+SlabListPush(SlabPage** list, SlabPage* page)
+{
+	page->Prev = nullptr;
+	page->Next = *list;
+	if (*list)
+		(*list)->Prev = page;
+	*list = page;
 }
 
 internal void
-InsertMemNodeBefore(AllocList* list, MemNode* insert, MemNode* curr)
+SlabListRemove(SlabPage** list, SlabPage* page)
+{
+	if (page->Prev) page->Prev->Next = page->Next;
+	else *list = page->Next;
+
+	if (page->Next) page->Next->Prev = page->Prev;
+
+	page->Next = page->Prev = nullptr;
+}
+
+internal _FORCE_INLINE_ uintptr_t
+HeapEnd(GeneralPurposeAllocator* allocator)
+{
+	return (allocator->Mem + allocator->Size) & ~(GENERALPURPOSE_ALIGNMENT - 1);
+}
+
+internal _FORCE_INLINE_ size_t
+UsedFootprint(GeneralPurposeAllocator* allocator)
 {
-	insert->Next = curr;
+	return (allocator->SlabTop - allocator->SlabBase) + (HeapEnd(allocator) - allocator->Offset);
+}
 
-	if (curr->Prev == nullptr) list->Head = insert;
+internal _FORCE_INLINE_ size_t
+CommittedBytes(GeneralPurposeAllocator* allocator)
+{
+	if (allocator->CommitLow >= allocator->CommitHigh)
+		return HeapEnd(allocator) - allocator->Mem;
 	else
+		return (allocator->CommitLow - allocator->Mem) + (HeapEnd(allocator) - allocator->CommitHigh);
+}
+
+// Commits the buffer up to top for slab pages, the space above CommitHigh already is
+internal bool
+CommitLowTo(GeneralPurposeAllocator* allocator, uintptr_t top)
+{
+	if (top <= allocator->CommitLow)
+		return true;
+
+	uintptr_t low = Min(AlignSize(top, VIRTUAL_MEMORY_COMMIT_SIZE), allocator->CommitHigh);
+	if (low > allocator->CommitLow)
 	{
-		insert->Prev = curr->Prev;
-		curr->Prev->Next = insert;
+		if (!VirtualMemoryCommit((void*)allocator->CommitLow, low - allocator->CommitLow))
+			return false;
+		allocator->CommitLow = low;
 	}
-
-	curr->Prev = insert;
+	return true;
 }
 
-internal MemNode*
-RemoveMemNode(AllocList* list, MemNode* node)
+// Commits the buffer down to bottom for top allocations
+internal bool
+CommitHighTo(GeneralPurposeAllocator* allocator, uintptr_t bottom)
 {
-	if (node->Prev != nullptr) node->Prev->Next = node->Next;
-	else
+	if (bottom >= allocator->CommitHigh)
+		return true;
+
+	uintptr_t high = bottom & ~(uintptr_t)(VIRTUAL_MEMORY_COMMIT_SIZE - 1);
+	high = Max(high, allocator->CommitLow);
+	if (high < allocator->CommitHigh)
 	{
-		list->Head = node->Next;
-		if (list->Head != nullptr) list->Head->Prev = nullptr;
-		else list->Tail = nullptr;
+		if (!VirtualMemoryCommit((void*)high, allocator->CommitHigh - high))
+			return false;
+		allocator->CommitHigh = high;
 	}
+	return true;
+}
 
-	if (node->Next != nullptr) node->Next->Prev = node->Prev;
+internal SlabPage*
+SlabPageCreate(GeneralPurposeAllocator* allocator, u16 classIndex)
+{
+	SlabPage* page = allocator->SlabFreePages;
+	if (page)
+	{
+		allocator->SlabFreePages = page->Next;
+	}
 	else
 	{
-		list->Tail = node->Prev;
-		if (list->Tail != nullptr) list->Tail->Next = nullptr;
-		else list->Head = nullptr;
+		// Slabs grow up into the same space as top allocations
+		if (allocator->SlabTop + GENERALPURPOSE_SLAB_PAGE_SIZE > allocator->Offset
+			|| !CommitLowTo(allocator, allocator->SlabTop + GENERALPURPOSE_SLAB_PAGE_SIZE))
+			return nullptr;
+
+		page = (SlabPage*)allocator->SlabTop;
+		allocator->SlabTop += GENERALPURPOSE_SLAB_PAGE_SIZE;
+		allocator->HighWater = Max(allocator->HighWater, UsedFootprint(allocator));
 	}
 
-	list->Length--;
+	SZero(page, sizeof(SlabPage));
+	page->ClassIndex = classIndex;
+	page->Capacity = (u16)((GENERALPURPOSE_SLAB_PAGE_SIZE - GENERALPURPOSE_SLAB_HEADER_SIZE) / GENERALPURPOSE_SLAB_SIZES[classIndex]);
 
-	return node;
+	// Slots past capacity are always used so the bit scan never finds them
+	u32 word = page->Capacity / 64;
+	if (page->Capacity % 64)
+		page->Used[word++] = ~0ULL << (page->Capacity % 64);
+	for (; word < GENERALPURPOSE_SLAB_BITMAP_WORDS; ++word)
+		page->Used[word] = ~0ULL;
+
+	return page;
 }
 
-internal MemNode*
-FindMemNode(AllocList* list, size_t bytes)
+internal void*
+SlabAlloc(GeneralPurposeAllocator* allocator, size_t size)
 {
-	for (MemNode* node = list->Head; node != nullptr; node = node->Next)
+	SAssert(size <= GENERALPURPOSE_SLAB_MAX_SIZE);
+
+	u16 classIndex = GENERALPURPOSE_SLAB_CLASS_LOOKUP[(size + 15) / 16];
+	SlabPage** partial = &allocator->SlabPartial[classIndex];
+	SlabPage* page = *partial;
+	if (!page)
 	{
-		if (node->Size < bytes)
-			continue;
+		page = SlabPageCreate(allocator, classIndex);
+		if (!page)
+			return nullptr;
 
-		// Try to reduce fragmentation. But can waste memory if allocating slightly above the largest
-		// freelist.
-		if (node->Size <= bytes + MEM_SPLIT_THRESHOLD)
-			return RemoveMemNode(list, node);
-		else
-			return SplitMemNode(node, bytes);
+		SlabListPush(partial, page);
+	}
+
+	SAssert(page->Count < page->Capacity);
+
+	u32 index = 0;
+	for (u32 word = 0; word < GENERALPURPOSE_SLAB_BITMAP_WORDS; ++word)
+	{
+		u64 freeSlots = ~page->Used[word];
+		if (freeSlots)
+		{
+			u32 bit = FindFirstSet(freeSlots);
+			page->Used[word] |= 1ULL << bit;
+			index = word * 64 + bit;
+			break;
+		}
 	}
+	SAssert(index < page->Capacity);
+
+	++page->Count;
+	if (page->Count == page->Capacity)
+		SlabListRemove(partial, page);
 
-	return nullptr;
+	return (u8*)page + GENERALPURPOSE_SLAB_HEADER_SIZE + index * GENERALPURPOSE_SLAB_SIZES[classIndex];
 }
 
 internal void
-InsertMemNode(GeneralPurposeAllocator* freelist, AllocList* list, MemNode* node, bool is_bucket)
+SlabFree(GeneralPurposeAllocator* allocator, void* ptr)
 {
-	if (list->Head == nullptr)
+	SlabPage* page = SlabPageFromPointer(allocator, ptr);
+	SAssert(page->Capacity > 0);
+	SAssert(page->Count > 0);
+
+	size_t objectSize = GENERALPURPOSE_SLAB_SIZES[page->ClassIndex];
+	size_t offset = (uintptr_t)ptr - ((uintptr_t)page + GENERALPURPOSE_SLAB_HEADER_SIZE);
+	SAssertMsg(offset % objectSize == 0, "Pointer is not the start of a slab object");
+
+	u32 index = (u32)(offset / objectSize);
+	SAssert(index < page->Capacity);
+
+	u64 bit = 1ULL << (index % 64);
+	SAssertMsg(page->Used[index / 64] & bit, "Slab object freed twice");
+	page->Used[index / 64] &= ~bit;
+
+	SlabPage** partial = &allocator->SlabPartial[page->ClassIndex];
+	if (page->Count == page->Capacity)
+		SlabListPush(partial, page);
+
+	--page->Count;
+
+	// Keeps the last page of a class around so a single alloc/free doesn't keep reinitializing it
+	if (page->Count == 0 && (page->Prev || page->Next))
 	{
-		list->Head = node;
-		list->Length++;
+		SlabListRemove(partial, page);
+		page->Capacity = 0;
+		page->Next = allocator->SlabFreePages;
+		allocator->SlabFreePages = page;
+	}
+}
+
+internal _FORCE_INLINE_ u32
+FindLastSet(size_t value)
+{
+	SAssert(value);
+#if _WIN32
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return (u32)index;
+#else
+	return 63 - (u32)__builtin_clzll(value);
+#endif
+}
+
+internal _FORCE_INLINE_ size_t
+MemNodeSize(MemNode* node)
+{
+	return node->Size & ~MEMNODE_FLAGS;
+}
+
+internal _FORCE_INLINE_ MemNode*
+MemNodeAbove(MemNode* node)
+{
+	return (MemNode*)((uintptr_t)node + MemNodeSize(node));
+}
+
+internal _FORCE_INLINE_ void
+BinMapping(size_t size, u32* outFl, u32* outSl)
+{
+	if (size < ((size_t)1 << GENERALPURPOSE_BIN_FL_SHIFT))
+	{
+		*outFl = 0;
+		*outSl = (u32)(size / (((size_t)1 << GENERALPURPOSE_BIN_FL_SHIFT) / GENERALPURPOSE_BIN_SL_COUNT));
 	}
 	else
 	{
-		for (MemNode* iter = list->Head; iter != nullptr; iter = iter->Next)
-		{
-			if ((uintptr_t)iter == freelist->Offset)
-			{
-				freelist->Offset += iter->Size;
-				RemoveMemNode(list, iter);
-				iter = list->Head;
+		u32 msb = FindLastSet(size);
+		*outFl = msb - GENERALPURPOSE_BIN_FL_SHIFT + 1;
+		*outSl = (u32)(size >> (msb - GENERALPURPOSE_BIN_SL_LOG2)) ^ GENERALPURPOSE_BIN_SL_COUNT;
+	}
+	SAssert(*outFl < GENERALPURPOSE_BIN_FL_COUNT);
+}
 
-				if (iter == nullptr)
-				{
-					list->Head = node;
-					return;
-				}
-			}
+internal void
+BinInsert(GeneralPurposeAllocator* allocator, MemNode* node)
+{
+	u32 fl, sl;
+	BinMapping(MemNodeSize(node), &fl, &sl);
 
-			const uintptr_t inode = (uintptr_t)node;
-			const uintptr_t iiter = (uintptr_t)iter;
-			const uintptr_t iter_end = iiter + iter->Size;
-			const uintptr_t node_end = inode + node->Size;
+	MemNode** head = &allocator->Bins[fl][sl];
+	node->Prev = nullptr;
+	node->Next = *head;
+	if (*head)
+		(*head)->Prev = node;
+	*head = node;
 
-			if (iter == node) return;
-			else if (iter < node)
-			{
-				// node was coalesced prior.
-				if (iter_end > inode) return;
-				else if ((iter_end == inode) && !is_bucket)
-				{
-					// if we can coalesce, do so.
-					iter->Size += node->Size;
+	allocator->BinFlBitmap |= 1u << fl;
+	allocator->BinSlBitmap[fl] |= 1u << sl;
+}
 
-					return;
-				}
-				else if (iter->Next == nullptr)
-				{
-					// we reached the end of the free list -> append the node
-					iter->Next = node;
-					node->Prev = iter;
-					list->Length++;
+internal void
+BinRemove(GeneralPurposeAllocator* allocator, MemNode* node)
+{
+	u32 fl, sl;
+	BinMapping(MemNodeSize(node), &fl, &sl);
 
-					return;
-				}
-			}
-			else if (iter > node)
-			{
-				// Address sort, lowest to highest aka ascending order.
-				if (iiter < node_end) return;
-				else if ((iter == list->Head) && !is_bucket)
-				{
-					if (iter_end == inode) iter->Size += node->Size;
-					else if (node_end == iiter)
-					{
-						node->Size += list->Head->Size;
-						node->Next = list->Head->Next;
-						node->Prev = nullptr;
-						list->Head = node;
-					}
-					else
-					{
-						node->Next = iter;
-						node->Prev = nullptr;
-						iter->Prev = node;
-						list->Head = node;
-						list->Length++;
-					}
-
-					return;
-				}
-				else if ((iter_end == inode) && !is_bucket)
-				{
-					// if we can coalesce, do so.
-					iter->Size += node->Size;
-					return;
-				}
-				else
-				{
-					InsertMemNodeBefore(list, node, iter);
-					list->Length++;
-					return;
-				}
-			}
+	if (node->Prev) node->Prev->Next = node->Next;
+	else
+	{
+		allocator->Bins[fl][sl] = node->Next;
+		if (!node->Next)
+		{
+			allocator->BinSlBitmap[fl] &= ~(1u << sl);
+			if (!allocator->BinSlBitmap[fl])
+				allocator->BinFlBitmap &= ~(1u << fl);
 		}
 	}
+
+	if (node->Next) node->Next->Prev = node->Prev;
 }
 
-GeneralPurposeAllocator FreelistCreate(SAllocator allocator, size_t bytes)
+// First block of the smallest non empty bin where every block fits size
+internal MemNode*
+BinFindFit(GeneralPurposeAllocator* allocator, size_t size)
 {
-	SAssert(IsAllocatorValid(allocator));
-	SAssert(bytes > 0);
+	// Rounds up to the next step, blocks in size's own bin can be smaller
+	size_t searchSize = size;
+	if (searchSize >= ((size_t)1 << GENERALPURPOSE_BIN_FL_SHIFT))
+		searchSize += ((size_t)1 << (FindLastSet(searchSize) - GENERALPURPOSE_BIN_SL_LOG2)) - 1;
 
-	GeneralPurposeAllocator freelist = { 0 };
+	u32 fl, sl;
+	BinMapping(searchSize, &fl, &sl);
 
-	if ((bytes == 0) || (bytes <= sizeof(MemNode)))
+	u32 slMap = allocator->BinSlBitmap[fl] & (~0u << sl);
+	if (!slMap)
 	{
-		SError("General purpose allocator, invalid size");
+		u32 flMap = allocator->BinFlBitmap & (~0u << (fl + 1));
+		if (!flMap)
+			return nullptr;
+
+		fl = FindFirstSet(flMap);
+		slMap = allocator->BinSlBitmap[fl];
 	}
-	else
+	sl = FindFirstSet(slMap);
+
+	MemNode* node = allocator->Bins[fl][sl];
+	SAssert(node);
+	SAssert(MemNodeSize(node) >= size);
+	return node;
+}
+
+internal void
+BinTotals(GeneralPurposeAllocator* allocator, size_t* outBytes, size_t* outNodes, size_t* outLargest)
+{
+	*outBytes = 0;
+	*outNodes = 0;
+	*outLargest = 0;
+	for (int fl = 0; fl < GENERALPURPOSE_BIN_FL_COUNT; ++fl)
 	{
-		void* buffer = SAlloc(allocator, bytes);
-		if (!buffer)
+		if (!allocator->BinSlBitmap[fl])
+			continue;
+
+		for (int sl = 0; sl < GENERALPURPOSE_BIN_SL_COUNT; ++sl)
 		{
-			SError("General purpose allocator, buffer is null");
-			return freelist;
+			for (MemNode* n = allocator->Bins[fl][sl]; n != nullptr; n = n->Next)
+			{
+				*outBytes += MemNodeSize(n);
+				*outNodes += 1;
+				*outLargest = Max(*outLargest, MemNodeSize(n));
+			}
 		}
-
-		freelist.Size = bytes;
-		freelist.Mem = (uintptr_t)buffer;
-		freelist.Offset = freelist.Mem + freelist.Size;
 	}
-	return freelist;
 }
 
 void GeneralPurposeCreate(GeneralPurposeAllocator* allocator, void* buffer, size_t bytes)
@@ -240,7 +388,7 @@ void GeneralPurposeCreate(GeneralPurposeAllocator* allocator, void* buffer, size
 
 	*allocator = {};
 
-	if ((bytes == 0) || (bytes <= sizeof(MemNode)) || !buffer)
+	if ((bytes == 0) || (bytes <= sizeof(MemNode)) || (bytes > UINT32_MAX) || !buffer)
 	{
 		SError("Invalid general purpose allocator");
 	}
@@ -248,175 +396,529 @@ void GeneralPurposeCreate(GeneralPurposeAllocator* allocator, void* buffer, size
 	{
 		allocator->Size = bytes;
 		allocator->Mem = (uintptr_t)buffer;
-		allocator->Offset = allocator->Mem + allocator->Size;
+		allocator->Offset = HeapEnd(allocator);
+		allocator->SlabBase = AlignSize(allocator->Mem, 16);
+		allocator->SlabTop = allocator->SlabBase;
+		allocator->CommitLow = allocator->Offset;
+		allocator->CommitHigh = allocator->Mem;
+		zpl_mutex_init(&allocator->Lock);
 	}
 }
 
-void* GeneralPurposeAlloc(GeneralPurposeAllocator* allocator, size_t size)
+void GeneralPurposeCreateVirtual(GeneralPurposeAllocator* allocator, size_t bytes)
 {
 	SAssert(allocator);
-	SAssert(size > 0);
-	SAssert(size < allocator->Size);
 
-	MemNode* newMemNode = nullptr;
-	size_t allocSize = AlignSize(size + sizeof(MemNode), GENERALPURPOSE_ALIGNMENT);
-	SAssert(allocSize >= GENERALPURPOSE_ALIGNMENT);
+	size_t size = AlignSize(bytes, VIRTUAL_MEMORY_COMMIT_SIZE);
+	void* buffer = VirtualMemoryReserve(size);
+	if (!buffer)
+	{
+		*allocator = {};
+		SError("[ Memory ] General purpose allocator failed to reserve %zu bytes", size);
+		return;
+	}
+
+	GeneralPurposeCreate(allocator, buffer, size);
+	allocator->IsVirtual = true;
+	allocator->CommitLow = allocator->Mem;
+	allocator->CommitHigh = HeapEnd(allocator);
+}
 
-	// We check large allocations right away
-	if (allocSize > GENERALPURPOSE_BUCKET_SIZES[GENERALPURPOSE_BUCKET_SIZE - 1])
+// Gives back what's committed in a virtual allocator, its memory must be unused
+internal void
+DecommitAll(GeneralPurposeAllocator* allocator)
+{
+	uintptr_t end = HeapEnd(allocator);
+	if (allocator->CommitLow >= allocator->CommitHigh)
 	{
-		newMemNode = FindMemNode(&allocator->Large, allocSize);
+		VirtualMemoryDecommit((void*)allocator->Mem, end - allocator->Mem);
 	}
 	else
 	{
-		allocSize = AlignPowTwo64Ceil(allocSize);
-		u32 bucketIndex = ConvertAllocSizeToIndex(allocSize);
-		AllocList* bucketList = allocator->Buckets + bucketIndex;
-		if (bucketList->Head)
-			newMemNode = RemoveMemNode(bucketList, bucketList->Head);
+		if (allocator->CommitLow > allocator->Mem)
+			VirtualMemoryDecommit((void*)allocator->Mem, allocator->CommitLow - allocator->Mem);
+		if (allocator->CommitHigh < end)
+			VirtualMemoryDecommit((void*)allocator->CommitHigh, end - allocator->CommitHigh);
 	}
+	allocator->CommitLow = allocator->Mem;
+	allocator->CommitHigh = end;
+}
+
+void GeneralPurposeDestroy(GeneralPurposeAllocator* allocator)
+{
+	SAssert(allocator);
+
+	zpl_mutex_destroy(&allocator->Lock);
+	if (allocator->IsVirtual)
+		VirtualMemoryRelease((void*)allocator->Mem, allocator->Size);
+	*allocator = {};
+}
 
-	if (!newMemNode)
+internal void*
+InternalAlloc(GeneralPurposeAllocator* allocator, size_t size)
+{
+	SAssert(allocator);
+	SAssert(size > 0);
+	SAssert(size < allocator->Size);
+
+	if (size <= GENERALPURPOSE_SLAB_MAX_SIZE)
+	{
+		void* slabMem = SlabAlloc(allocator, size);
+		if (slabMem)
+			return slabMem;
+
+		// Out of slab pages, a freed block might still fit it
+	}
+
+	size_t blockSize = Max(AlignSize(size + MEMNODE_HEADER_SIZE, GENERALPURPOSE_ALIGNMENT), MEMNODE_MIN_SIZE);
+	uintptr_t end = HeapEnd(allocator);
+
+	MemNode* node = BinFindFit(allocator, blockSize);
+	if (node)
+	{
+		BinRemove(allocator, node);
+
+		size_t nodeSize = MemNodeSize(node);
+		MemNode* above = MemNodeAbove(node);
+		if (nodeSize - blockSize >= MEMNODE_SPLIT_THRESHOLD)
+		{
+			// The rest stays free, the block above already has PREV_FREE set
+			MemNode* rest = (MemNode*)((uintptr_t)node + blockSize);
+			rest->Size = (nodeSize - blockSize) | MEMNODE_FREE;
+			BinInsert(allocator, rest);
+			if ((uintptr_t)above < end)
+				above->PrevSize = nodeSize - blockSize;
+			nodeSize = blockSize;
+		}
+		else if ((uintptr_t)above < end)
+		{
+			above->Size &= ~MEMNODE_PREV_FREE;
+		}
+
+		// Free blocks are never next to each other, so nothing below is free
+		node->Size = nodeSize;
+	}
+	else
 	{
 		// not enough memory to support the size!
-		if ((allocator->Offset - allocSize) < allocator->Mem)
+		if (allocator->Offset - allocator->SlabTop < blockSize
+			|| !CommitHighTo(allocator, allocator->Offset - blockSize))
 		{
 			SError("[ Memory ] Memory Arena is out of memory!");
 			return nullptr;
 		}
-		else
-		{
-			// TODO Maybe alloc new allocations from large list?
 
-			// Couldn't allocate from a freelist, allocate from available freelist.
-			// Subtract allocation size from the freelist.
-			allocator->Offset -= allocSize;
-
-			// Use the available freelist space as the new node.
-			newMemNode = (MemNode*)allocator->Offset;
-			newMemNode->Size = allocSize;
-		}
+		// Nothing free fits, take it from the buffer
+		allocator->Offset -= blockSize;
+		node = (MemNode*)allocator->Offset;
+		node->Size = blockSize;
+		allocator->HighWater = Max(allocator->HighWater, UsedFootprint(allocator));
 	}
 
 	// Visual of the allocation block.
 	// --------------
-	// | mem size   | lowest addr of block
-	// | next node  | 12 byte (32-bit) header
-	// | prev node  | 24 byte (64-bit) header
+	// | size|flags | lowest addr of block
+	// | prev size  | 16 byte header
 	// |------------|
-	// |   alloc'd  |
-	// |   memory   |
+	// |   alloc'd  | next/prev bin links
+	// |   memory   | when free
 	// |   space    | highest addr of block
 	// --------------
-	newMemNode->Next = newMemNode->Prev = nullptr;
-	uint8_t* final_mem = (uint8_t*)newMemNode + sizeof(*newMemNode);
-	SAssert(final_mem);
-	return final_mem;
+	return (u8*)node + MEMNODE_HEADER_SIZE;
 }
 
-void* GeneralPurposeRealloc(GeneralPurposeAllocator* _RESTRICT_ freelist, void* _RESTRICT_ ptr, size_t size)
-{
-	SAssert(freelist);
-	SAssert(size <= freelist->Size);
+internal void
+InternalFree(GeneralPurposeAllocator* _RESTRICT_ freelist, void* _RESTRICT_ ptr);
 
-	if (!ptr)
+// Only for blocks from the top, slab objects are handled by GeneralPurposeRealloc
+internal void*
+InternalRealloc(GeneralPurposeAllocator* _RESTRICT_ freelist, void* _RESTRICT_ ptr, size_t size)
+{
+	uintptr_t end = HeapEnd(freelist);
+	MemNode* node = (MemNode*)((uintptr_t)ptr - MEMNODE_HEADER_SIZE);
+	SAssert((uintptr_t)node >= freelist->Offset);
+	SAssert((uintptr_t)node < end);
+	// REVISIT maybe just use the asserts
+	if ((uintptr_t)node < freelist->Offset || (uintptr_t)node >= end)
 	{
-		return GeneralPurposeAlloc(freelist, size);
+		SError("Invalid pointer");
+		return nullptr;
 	}
-	else // Handles a full free and alloc here
-	{
-		uintptr_t block = (uintptr_t)ptr - sizeof(MemNode);
-		SAssert(block >= freelist->Offset);
-		SAssert(block - freelist->Mem <= freelist->Size);
-		// REVISIT maybe just use the asserts
-		if (block < freelist->Offset || block - freelist->Mem > freelist->Size)
-		{
-			SError("Invalid pointer");
-			return nullptr;
-		}
 
-		MemNode* node = (MemNode*)block;
-		SAssert(node->Size != 0);
-		SAssert(node->Size < freelist->Size);
+	size_t nodeSize = MemNodeSize(node);
+	SAssert(nodeSize != 0);
+	SAssert(!(node->Size & MEMNODE_FREE));
 
-		if (size < node->Size)
-			return ptr;
+	size_t blockSize = Max(AlignSize(size + MEMNODE_HEADER_SIZE, GENERALPURPOSE_ALIGNMENT), MEMNODE_MIN_SIZE);
+	if (blockSize <= nodeSize)
+		return ptr;
 
-		uint8_t* resized_block = (uint8_t*)GeneralPurposeAlloc(freelist, size);
-		SAssert(resized_block);
+	// Grow in place when the block above is free and big enough
+	MemNode* above = MemNodeAbove(node);
+	if ((uintptr_t)above < end && (above->Size & MEMNODE_FREE) && nodeSize + MemNodeSize(above) >= blockSize)
+	{
+		BinRemove(freelist, above);
 
-		if (resized_block)
+		size_t total = nodeSize + MemNodeSize(above);
+		MemNode* next = (MemNode*)((uintptr_t)node + total);
+		if (total - blockSize >= MEMNODE_SPLIT_THRESHOLD)
 		{
-			MemNode* resized = (MemNode*)(resized_block - sizeof(MemNode));
-			SMemMove(resized_block, ptr, (node->Size > resized->Size)
-					? (resized->Size - sizeof(MemNode)) : (node->Size - sizeof(MemNode)));
-			GeneralPurposeFree(freelist, ptr);
-			SAssert(ptr);
-			return resized_block;
+			MemNode* rest = (MemNode*)((uintptr_t)node + blockSize);
+			rest->Size = (total - blockSize) | MEMNODE_FREE;
+			BinInsert(freelist, rest);
+			if ((uintptr_t)next < end)
+				next->PrevSize = total - blockSize;
+			total = blockSize;
 		}
+		else if ((uintptr_t)next < end)
+		{
+			next->Size &= ~MEMNODE_PREV_FREE;
+		}
+
+		node->Size = total | (node->Size & MEMNODE_PREV_FREE);
+		return ptr;
 	}
-	return nullptr;
+
+	void* resized = InternalAlloc(freelist, size);
+	SAssert(resized);
+
+	if (resized)
+	{
+		SMemMove(resized, ptr, nodeSize - MEMNODE_HEADER_SIZE);
+		InternalFree(freelist, ptr);
+	}
+	return resized;
 }
 
-void GeneralPurposeFree(GeneralPurposeAllocator* _RESTRICT_ freelist, void* _RESTRICT_ ptr)
+internal void
+InternalFree(GeneralPurposeAllocator* _RESTRICT_ freelist, void* _RESTRICT_ ptr)
 {
-	static_assert(ArrayLength(GENERALPURPOSE_BUCKET_SIZES) == GENERALPURPOSE_BUCKET_SIZE, "GENERALPURPOSE_BUCKET_SIZES Count is not FREELIST_BUCKET_SIZE");
-
 	SAssert(freelist);
 
 	if (!ptr)
 		return;
+	else if (IsSlabPointer(freelist, ptr))
+	{
+		SlabFree(freelist, ptr);
+	}
 	else
 	{
-		// Behind the actual pointer data is the allocation info.
-		uintptr_t block = (uintptr_t)ptr - sizeof(MemNode);
-		MemNode* mem_node = (MemNode*)block;
+		uintptr_t end = HeapEnd(freelist);
+		MemNode* node = (MemNode*)((uintptr_t)ptr - MEMNODE_HEADER_SIZE);
 
-		SAssert(block >= freelist->Offset);
-		SAssert(block - freelist->Mem <= freelist->Size);
-		SAssert(mem_node->Size > 0);
-		SAssert(mem_node->Size < freelist->Size);
+		SAssert((uintptr_t)node >= freelist->Offset);
+		SAssert((uintptr_t)node < end);
+		SAssertMsg(!(node->Size & MEMNODE_FREE), "Block freed twice");
 
 		// REVISIT maybe just use the asserts
-		if (block < freelist->Offset || block - freelist->Mem > freelist->Size)
+		if ((uintptr_t)node < freelist->Offset || (uintptr_t)node >= end)
 		{
 			SError("Invalid pointer");
 			return;
 		}
 
-		// If the mem_node is right at the arena offs, then merge it back to the arena.
-		if (block == freelist->Offset)
+		size_t size = MemNodeSize(node);
+
+		MemNode* above = MemNodeAbove(node);
+		if ((uintptr_t)above < end && (above->Size & MEMNODE_FREE))
+		{
+			BinRemove(freelist, above);
+			size += MemNodeSize(above);
+		}
+
+		if (node->Size & MEMNODE_PREV_FREE)
 		{
-			freelist->Offset += mem_node->Size;
+			MemNode* below = (MemNode*)((uintptr_t)node - node->PrevSize);
+			SAssert(below->Size & MEMNODE_FREE);
+			SAssert(MemNodeSize(below) == node->PrevSize);
+			BinRemove(freelist, below);
+			size += MemNodeSize(below);
+			node = below;
 		}
-		else if (mem_node->Size <= GENERALPURPOSE_BUCKET_SIZES[GENERALPURPOSE_BUCKET_SIZE - 1])
+
+		above = (MemNode*)((uintptr_t)node + size);
+		if ((uintptr_t)node == freelist->Offset)
 		{
-			u32 bucketIndex = ConvertAllocSizeToIndex(mem_node->Size);
-			AllocList* bucketList = freelist->Buckets + bucketIndex;
-			InsertMemNode(freelist, bucketList, mem_node, true);
+			// Lowest block goes back to the buffer
+			freelist->Offset += size;
+			if ((uintptr_t)above < end)
+				above->Size &= ~MEMNODE_PREV_FREE;
 		}
 		else
 		{
-			InsertMemNode(freelist, &freelist->Large, mem_node, false);
+			node->Size = size | MEMNODE_FREE;
+			BinInsert(freelist, node);
+			if ((uintptr_t)above < end)
+			{
+				above->Size |= MEMNODE_PREV_FREE;
+				above->PrevSize = size;
+			}
+		}
+	}
+}
+
+//
+// Thread safe front end
+//
+
+// Each thread gets a slot the first time it allocates, caches are per allocator and slot.
+// A bit per slot, set while a thread holds it.
+internal_var zpl_atomic64 UsedThreadSlots;
+thread_local internal_var int ThreadSlot = -1;
+static_assert(GENERALPURPOSE_MAX_THREADS <= 64, "UsedThreadSlots has a bit per slot");
+
+internal int
+ClaimThreadSlot()
+{
+	u64 used = (u64)zpl_atomic64_load(&UsedThreadSlots);
+	while (~used != 0)
+	{
+		u32 slot = FindFirstSet(~used);
+		if (slot >= GENERALPURPOSE_MAX_THREADS)
+			break;
+
+		u64 prev = (u64)zpl_atomic64_compare_exchange(&UsedThreadSlots, (i64)used, (i64)(used | (1ull << slot)));
+		if (prev == used)
+			return (int)slot;
+		used = prev;
+	}
+	return GENERALPURPOSE_MAX_THREADS;
+}
+
+internal GeneralPurposeThreadCache*
+GetThreadCache(GeneralPurposeAllocator* allocator)
+{
+	if (ThreadSlot < 0)
+		ThreadSlot = ClaimThreadSlot();
+
+	// Threads past the limit always take the lock
+	if (ThreadSlot >= GENERALPURPOSE_MAX_THREADS)
+		return nullptr;
+
+	GeneralPurposeThreadCache* cache = allocator->ThreadCaches[ThreadSlot];
+	if (!cache)
+	{
+		zpl_mutex_lock(&allocator->Lock);
+		cache = (GeneralPurposeThreadCache*)InternalAlloc(allocator, sizeof(GeneralPurposeThreadCache));
+		if (cache)
+		{
+			SZero(cache, sizeof(GeneralPurposeThreadCache));
+			allocator->ThreadCaches[ThreadSlot] = cache;
 		}
+		zpl_mutex_unlock(&allocator->Lock);
+	}
+	return cache;
+}
+
+// zpl_mutex_try_lock returns pthread_mutex_trylock's result, 0 on success, outside of Windows
+internal _FORCE_INLINE_ bool
+TryLock(zpl_mutex* mutex)
+{
+#if _WIN32
+	return zpl_mutex_try_lock(mutex);
+#else
+	return zpl_mutex_try_lock(mutex) == 0;
+#endif
+}
+
+// Frees pushed while another thread held the lock. Lock must be held.
+internal void
+DrainRemoteFrees(GeneralPurposeAllocator* allocator)
+{
+	MemNode* node = (MemNode*)zpl_atomic_ptr_exchange(&allocator->RemoteFrees, nullptr);
+	while (node)
+	{
+		MemNode* next = node->Next;
+		node->Next = nullptr;
+		InternalFree(allocator, (u8*)node + MEMNODE_HEADER_SIZE);
+		node = next;
+	}
+}
+
+internal void
+PushRemoteFree(GeneralPurposeAllocator* allocator, void* ptr)
+{
+	// Only pushes and taking the whole list, so no ABA
+	MemNode* node = (MemNode*)((uintptr_t)ptr - MEMNODE_HEADER_SIZE);
+	void* head;
+	do
+	{
+		head = zpl_atomic_ptr_load(&allocator->RemoteFrees);
+		node->Next = (MemNode*)head;
+	} while (zpl_atomic_ptr_compare_exchange(&allocator->RemoteFrees, head, node) != head);
+}
+
+void* GeneralPurposeAlloc(GeneralPurposeAllocator* allocator, size_t size)
+{
+	SAssert(allocator);
+	SAssert(size > 0);
+	SAssert(size < allocator->Size);
+
+	if (size <= GENERALPURPOSE_SLAB_MAX_SIZE)
+	{
+		GeneralPurposeThreadCache* cache = GetThreadCache(allocator);
+		if (cache)
+		{
+			u16 classIndex = GENERALPURPOSE_SLAB_CLASS_LOOKUP[(size + 15) / 16];
+			SlabMagazine* magazine = &cache->Magazines[classIndex];
+			if (magazine->Count == 0)
+			{
+				// Refill half so a following free doesn't have to flush right away
+				zpl_mutex_lock(&allocator->Lock);
+				DrainRemoteFrees(allocator);
+				while (magazine->Count < GENERALPURPOSE_MAGAZINE_SIZE / 2)
+				{
+					void* obj = SlabAlloc(allocator, GENERALPURPOSE_SLAB_SIZES[classIndex]);
+					if (!obj)
+						break;
+					magazine->Objects[magazine->Count++] = obj;
+				}
+				zpl_mutex_unlock(&allocator->Lock);
+			}
+
+			if (magazine->Count > 0)
+				return magazine->Objects[--magazine->Count];
+		}
+	}
+
+	zpl_mutex_lock(&allocator->Lock);
+	DrainRemoteFrees(allocator);
+	void* res = InternalAlloc(allocator, size);
+	zpl_mutex_unlock(&allocator->Lock);
+	return res;
+}
+
+void* GeneralPurposeRealloc(GeneralPurposeAllocator* _RESTRICT_ allocator, void* _RESTRICT_ ptr, size_t size)
+{
+	SAssert(allocator);
+	SAssert(size <= allocator->Size);
+
+	if (!ptr)
+	{
+		return GeneralPurposeAlloc(allocator, size);
+	}
+	else if (IsSlabPointer(allocator, ptr))
+	{
+		// Class of a live object can't change, no lock needed
+		size_t objectSize = GENERALPURPOSE_SLAB_SIZES[SlabPageFromPointer(allocator, ptr)->ClassIndex];
+		if (size <= objectSize)
+			return ptr;
+
+		void* resized = GeneralPurposeAlloc(allocator, size);
+		SAssert(resized);
+
+		if (resized)
+		{
+			SCopy(resized, ptr, objectSize);
+			GeneralPurposeFree(allocator, ptr);
+		}
+		return resized;
+	}
+	else
+	{
+		zpl_mutex_lock(&allocator->Lock);
+		DrainRemoteFrees(allocator);
+		void* res = InternalRealloc(allocator, ptr, size);
+		zpl_mutex_unlock(&allocator->Lock);
+		return res;
+	}
+}
+
+void GeneralPurposeFree(GeneralPurposeAllocator* _RESTRICT_ allocator, void* _RESTRICT_ ptr)
+{
+	SAssert(allocator);
+
+	if (!ptr)
+		return;
+
+	// SlabTop only grows while pages are in use, so a stale read can't misplace a live pointer
+	if (IsSlabPointer(allocator, ptr))
+	{
+		GeneralPurposeThreadCache* cache = GetThreadCache(allocator);
+		if (cache)
+		{
+			// Objects from other threads are fine here, every thread shares the same slab pages
+			SlabMagazine* magazine = &cache->Magazines[SlabPageFromPointer(allocator, ptr)->ClassIndex];
+			if (magazine->Count == GENERALPURPOSE_MAGAZINE_SIZE)
+			{
+				zpl_mutex_lock(&allocator->Lock);
+				while (magazine->Count > GENERALPURPOSE_MAGAZINE_SIZE / 2)
+					SlabFree(allocator, magazine->Objects[--magazine->Count]);
+				zpl_mutex_unlock(&allocator->Lock);
+			}
+			magazine->Objects[magazine->Count++] = ptr;
+			return;
+		}
+
+		zpl_mutex_lock(&allocator->Lock);
+		SlabFree(allocator, ptr);
+		zpl_mutex_unlock(&allocator->Lock);
+	}
+	else if (TryLock(&allocator->Lock))
+	{
+		DrainRemoteFrees(allocator);
+		InternalFree(allocator, ptr);
+		zpl_mutex_unlock(&allocator->Lock);
 	}
+	else
+	{
+		// Whoever holds the lock, or takes it next, frees it
+		PushRemoteFree(allocator, ptr);
+	}
+}
+
+void GeneralPurposeFlushThreadCache(GeneralPurposeAllocator* allocator)
+{
+	SAssert(allocator);
+
+	if (ThreadSlot < 0 || ThreadSlot >= GENERALPURPOSE_MAX_THREADS)
+		return;
+
+	GeneralPurposeThreadCache* cache = allocator->ThreadCaches[ThreadSlot];
+	if (!cache)
+		return;
+
+	zpl_mutex_lock(&allocator->Lock);
+	for (int i = 0; i < GENERALPURPOSE_SLAB_CLASS_COUNT; ++i)
+	{
+		SlabMagazine* magazine = &cache->Magazines[i];
+		while (magazine->Count > 0)
+			SlabFree(allocator, magazine->Objects[--magazine->Count]);
+	}
+	zpl_mutex_unlock(&allocator->Lock);
+}
+
+void GeneralPurposeReleaseThreadSlot()
+{
+	if (ThreadSlot >= 0 && ThreadSlot < GENERALPURPOSE_MAX_THREADS)
+		zpl_atomic64_fetch_and(&UsedThreadSlots, ~(i64)(1ull << ThreadSlot));
+	ThreadSlot = -1;
 }
 
 size_t GeneralPurposeGetFreeMemory(GeneralPurposeAllocator* freelist)
 {
 	SAssert(freelist);
 
-	size_t total_remaining = freelist->Offset - freelist->Mem;
+	zpl_mutex_lock(&freelist->Lock);
+	DrainRemoteFrees(freelist);
 
-	for (MemNode* n = freelist->Large.Head; n != nullptr; n = n->Next)
-		total_remaining += n->Size;
+	size_t total_remaining = freelist->Offset - freelist->SlabTop;
 
-	for (size_t i = 0; i < GENERALPURPOSE_BUCKET_SIZE; i++)
+	for (uintptr_t p = freelist->SlabBase; p < freelist->SlabTop; p += GENERALPURPOSE_SLAB_PAGE_SIZE)
 	{
-		for (MemNode* n = freelist->Buckets[i].Head; n != nullptr; n = n->Next)
-			total_remaining += n->Size;
+		SlabPage* page = (SlabPage*)p;
+		if (page->Capacity == 0)
+			total_remaining += GENERALPURPOSE_SLAB_PAGE_SIZE;
+		else
+			total_remaining += (size_t)(page->Capacity - page->Count) * GENERALPURPOSE_SLAB_SIZES[page->ClassIndex];
 	}
 
+	size_t binBytes, binNodes, largest;
+	BinTotals(freelist, &binBytes, &binNodes, &largest);
+	total_remaining += binBytes;
+
+	zpl_mutex_unlock(&freelist->Lock);
+
 	return total_remaining;
 }
 
@@ -424,14 +926,298 @@ void GeneralPurposeClearAll(GeneralPurposeAllocator* freelist)
 {
 	SAssert(freelist);
 
-	freelist->Large.Head = freelist->Large.Tail = nullptr;
-	freelist->Large.Length = 0;
+	// Not safe with other threads still using it, their cached objects are lost
+	zpl_mutex_lock(&freelist->Lock);
+
+	freelist->BinFlBitmap = 0;
+	SZero(freelist->BinSlBitmap, sizeof(freelist->BinSlBitmap));
+	SZero(freelist->Bins, sizeof(freelist->Bins));
+
+	for (int i = 0; i < GENERALPURPOSE_SLAB_CLASS_COUNT; ++i)
+		freelist->SlabPartial[i] = nullptr;
+
+	for (int i = 0; i < GENERALPURPOSE_MAX_THREADS; ++i)
+		freelist->ThreadCaches[i] = nullptr;
+
+	zpl_atomic_ptr_store(&freelist->RemoteFrees, nullptr);
+	freelist->SlabFreePages = nullptr;
+	freelist->SlabTop = freelist->SlabBase;
+	freelist->Offset = HeapEnd(freelist);
 
-	for (size_t i = 0; i < GENERALPURPOSE_BUCKET_SIZE; i++)
+	if (freelist->IsVirtual)
+		DecommitAll(freelist);
+
+	zpl_mutex_unlock(&freelist->Lock);
+}
+
+void GeneralPurposeGetStats(GeneralPurposeAllocator* allocator, GeneralPurposeStats* outStats)
+{
+	SAssert(allocator);
+	SAssert(outStats);
+
+	*outStats = {};
+	for (int i = 0; i < GENERALPURPOSE_SLAB_CLASS_COUNT; ++i)
+		outStats->Slabs[i].ObjectSize = GENERALPURPOSE_SLAB_SIZES[i];
+
+	zpl_mutex_lock(&allocator->Lock);
+	DrainRemoteFrees(allocator);
+
+	// Other threads change their counts without the lock, only an estimate
+	for (int i = 0; i < GENERALPURPOSE_MAX_THREADS; ++i)
+	{
+		GeneralPurposeThreadCache* cache = allocator->ThreadCaches[i];
+		if (!cache)
+			continue;
+
+		for (int j = 0; j < GENERALPURPOSE_SLAB_CLASS_COUNT; ++j)
+			outStats->SlabCachedBytes += (size_t)cache->Magazines[j].Count * GENERALPURPOSE_SLAB_SIZES[j];
+	}
+
+	for (uintptr_t p = allocator->SlabBase; p < allocator->SlabTop; p += GENERALPURPOSE_SLAB_PAGE_SIZE)
 	{
-		freelist->Buckets[i].Head = freelist->Buckets[i].Tail = nullptr;
-		freelist->Buckets[i].Length = 0;
+		SlabPage* page = (SlabPage*)p;
+		if (page->Capacity == 0)
+		{
+			++outStats->SlabFreePages;
+			continue;
+		}
+
+		GeneralPurposeSlabStats* slab = &outStats->Slabs[page->ClassIndex];
+		++slab->Pages;
+		slab->Used += page->Count;
+		slab->Capacity += page->Capacity;
+		outStats->SlabUsedBytes += (size_t)page->Count * slab->ObjectSize;
 	}
 
-	freelist->Offset = freelist->Mem + freelist->Size;
+	outStats->SlabBytes = allocator->SlabTop - allocator->SlabBase;
+	outStats->SlabWasteBytes = outStats->SlabBytes - outStats->SlabUsedBytes;
+
+	BinTotals(allocator, &outStats->LargeFreeBytes, &outStats->LargeFreeNodes, &outStats->LargestFreeNode);
+
+	outStats->LargeUsedBytes = (HeapEnd(allocator) - allocator->Offset) - outStats->LargeFreeBytes;
+	outStats->UnreservedBytes = allocator->Offset - allocator->SlabTop;
+	outStats->CommittedBytes = CommittedBytes(allocator);
+
+	zpl_mutex_unlock(&allocator->Lock);
+}
+
+void GeneralPurposeTakeFrameStats(GeneralPurposeAllocator* allocator, GeneralPurposeFrameStats* outStats)
+{
+	SAssert(allocator);
+	SAssert(outStats);
+
+	zpl_mutex_lock(&allocator->Lock);
+	outStats->HighWaterBytes = Max(allocator->HighWater, UsedFootprint(allocator));
+	outStats->CommittedBytes = CommittedBytes(allocator);
+	allocator->HighWater = UsedFootprint(allocator);
+	zpl_mutex_unlock(&allocator->Lock);
+}
+
+void GeneralPurposeLogReport(GeneralPurposeAllocator* allocator)
+{
+	GeneralPurposeStats stats;
+	GeneralPurposeGetStats(allocator, &stats);
+
+	SInfoLog("[ Memory ] General purpose: %zukb unreserved of %zukb, %zukb committed",
+			 stats.UnreservedBytes / 1024, allocator->Size / 1024, stats.CommittedBytes / 1024);
+	SInfoLog("[ Memory ] Slabs: %zukb in pages, %zukb used (%zukb in thread caches), %zukb waste, %u free pages",
+			 stats.SlabBytes / 1024, stats.SlabUsedBytes / 1024, stats.SlabCachedBytes / 1024,
+			 stats.SlabWasteBytes / 1024, stats.SlabFreePages);
+	for (int i = 0; i < GENERALPURPOSE_SLAB_CLASS_COUNT; ++i)
+	{
+		GeneralPurposeSlabStats* slab = &stats.Slabs[i];
+		if (slab->Pages == 0)
+			continue;
+
+		SInfoLog("[ Memory ]   %zub: %u pages, %u/%u objects (%.1f%% full)",
+				 slab->ObjectSize, slab->Pages, slab->Used, slab->Capacity,
+				 100.0 * (double)slab->Used / (double)slab->Capacity);
+	}
+	SInfoLog("[ Memory ] Large: %zukb used, %zukb free in %zu nodes, largest %zukb",
+			 stats.LargeUsedBytes / 1024, stats.LargeFreeBytes / 1024, stats.LargeFreeNodes, stats.LargestFreeNode / 1024);
+}
+
+void TestGeneralPurposeAllocator()
+{
+	size_t size = Megabytes(1);
+	void* buffer = SAlloc(SAllocatorMalloc(), size);
+
+	GeneralPurposeAllocator gpa;
+	GeneralPurposeCreate(&gpa, buffer, size);
+
+	// Small sizes share pages and have no header
+	u8* a = (u8*)GeneralPurposeAlloc(&gpa, 16);
+	u8* b = (u8*)GeneralPurposeAlloc(&gpa, 16);
+	u8* c = (u8*)GeneralPurposeAlloc(&gpa, 100);
+	SAssert(((a > b) ? a - b : b - a) == 16);
+	SAssert(IsSlabPointer(&gpa, c));
+	SAssert(SlabPageFromPointer(&gpa, a) != SlabPageFromPointer(&gpa, c));
+	SAssert(GENERALPURPOSE_SLAB_SIZES[SlabPageFromPointer(&gpa, c)->ClassIndex] == 128);
+
+	// Freed slots are reused first
+	GeneralPurposeFree(&gpa, a);
+	u8* reused = (u8*)GeneralPurposeAlloc(&gpa, 8);
+	SAssert(reused == a);
+
+	// Growing within the class keeps the pointer, past it moves
+	u8* grown = (u8*)GeneralPurposeRealloc(&gpa, c, 128);
+	SAssert(grown == c);
+	c[0] = 42;
+	u8* d = (u8*)GeneralPurposeRealloc(&gpa, c, 200);
+	SAssert(d != c && d[0] == 42);
+	u8* e = (u8*)GeneralPurposeRealloc(&gpa, d, 1000);
+	SAssert(!IsSlabPointer(&gpa, e) && e[0] == 42);
+
+	// More than 2 pages of one class, emptied pages go to the free list
+	constexpr int count = 600;
+	void* ptrs[count];
+	for (int i = 0; i < count; ++i)
+	{
+		ptrs[i] = GeneralPurposeAlloc(&gpa, 64);
+		SAssert(ptrs[i]);
+	}
+
+	GeneralPurposeStats stats;
+	GeneralPurposeFlushThreadCache(&gpa);
+	GeneralPurposeGetStats(&gpa, &stats);
+	SAssert(stats.Slabs[3].Used == count);
+	SAssert(stats.Slabs[3].Pages == 3);
+
+	for (int i = 0; i < count; ++i)
+		GeneralPurposeFree(&gpa, ptrs[i]);
+
+	GeneralPurposeFlushThreadCache(&gpa);
+	GeneralPurposeGetStats(&gpa, &stats);
+	SAssert(stats.Slabs[3].Used == 0);
+	SAssert(stats.Slabs[3].Pages == 1);
+	SAssert(stats.SlabFreePages == 2);
+
+	// A new class takes a free page instead of growing
+	uintptr_t slabTop = gpa.SlabTop;
+	void* f = GeneralPurposeAlloc(&gpa, 48);
+	SAssert(gpa.SlabTop == slabTop);
+
+	GeneralPurposeFree(&gpa, f);
+	GeneralPurposeFree(&gpa, a);
+	GeneralPurposeFree(&gpa, b);
+	GeneralPurposeFree(&gpa, e);
+	GeneralPurposeFlushThreadCache(&gpa);
+	GeneralPurposeGetStats(&gpa, &stats);
+	SAssert(stats.SlabUsedBytes == 0);
+
+	// Only this thread's cache is left
+	size_t cacheBytes = AlignSize(sizeof(GeneralPurposeThreadCache) + MEMNODE_HEADER_SIZE, GENERALPURPOSE_ALIGNMENT);
+	SAssert(stats.LargeUsedBytes == cacheBytes);
+
+	// Freed neighbours merge, and go back to the buffer once they reach it
+	uintptr_t offset = gpa.Offset;
+	void* x = GeneralPurposeAlloc(&gpa, 1000);
+	void* y = GeneralPurposeAlloc(&gpa, 2000);
+	void* z = GeneralPurposeAlloc(&gpa, 3000);
+	GeneralPurposeFree(&gpa, x);
+	GeneralPurposeFree(&gpa, y);
+	GeneralPurposeGetStats(&gpa, &stats);
+	SAssert(stats.LargeFreeNodes == 1);
+	SAssert(stats.LargeFreeBytes == 1024 + 2016);
+
+	void* w = GeneralPurposeAlloc(&gpa, 2500);
+	SAssert(w == y);
+	void* wGrown = GeneralPurposeRealloc(&gpa, w, 3000);
+	SAssert(wGrown == w);
+
+	GeneralPurposeFree(&gpa, w);
+	GeneralPurposeFree(&gpa, z);
+	GeneralPurposeGetStats(&gpa, &stats);
+	SAssert(stats.LargeFreeNodes == 0);
+	SAssert(gpa.Offset == offset);
+
+	// Jobs allocating and freeing each other's memory
+	JobHandle handle = {};
+	JobsDispatch(&handle, 32, 1, [](JobArgs* args)
+				 {
+					 GeneralPurposeAllocator* gpa = (GeneralPurposeAllocator*)args->StackMemory;
+					 u8* live[16] = {};
+					 for (u32 i = 0; i < 512; ++i)
+					 {
+						 u32 slot = (i * 7 + args->JobIndex) % ArrayLength(live);
+						 if (live[slot])
+						 {
+							 SAssert(live[slot][0] == (u8)args->JobIndex);
+							 GeneralPurposeFree(gpa, live[slot]);
+						 }
+
+						 size_t allocSize = (i % 8 == 0) ? 300 + i : 1 + (i * 13) % 256;
+						 live[slot] = (u8*)GeneralPurposeAlloc(gpa, allocSize);
+						 SAssert(live[slot]);
+						 live[slot][0] = (u8)args->JobIndex;
+					 }
+
+					 for (int i = 0; i < ArrayLength(live); ++i)
+						 GeneralPurposeFree(gpa, live[i]);
+				 }, &gpa);
+	JobHandleWait(&handle);
+
+	// Everything was freed, slab objects can still sit in the workers' caches
+	GeneralPurposeGetStats(&gpa, &stats);
+	SAssert(stats.SlabUsedBytes == stats.SlabCachedBytes);
+	size_t workerCachedBytes = stats.SlabCachedBytes;
+
+	// More short lived threads than there are slots, each gives its slot back as it exits
+	i64 usedSlots = zpl_atomic64_load(&UsedThreadSlots);
+	for (int round = 0; round < GENERALPURPOSE_MAX_THREADS / 4; ++round)
+	{
+		zpl_thread threads[8];
+		for (int i = 0; i < ArrayLength(threads); ++i)
+		{
+			zpl_thread_init(&threads[i]);
+			zpl_thread_start(&threads[i], [](zpl_thread* thread)
+							 {
+								 GeneralPurposeAllocator* gpa = (GeneralPurposeAllocator*)thread->user_data;
+								 void* objects[64];
+								 for (int i = 0; i < ArrayLength(objects); ++i)
+									 objects[i] = GeneralPurposeAlloc(gpa, 16 + (i % 8) * 16);
+								 SAssert(ThreadSlot >= 0 && ThreadSlot < GENERALPURPOSE_MAX_THREADS);
+								 for (int i = 0; i < ArrayLength(objects); ++i)
+									 GeneralPurposeFree(gpa, objects[i]);
+
+								 GeneralPurposeFlushThreadCache(gpa);
+								 GeneralPurposeReleaseThreadSlot();
+								 return (zpl_isize)0;
+							 }, &gpa);
+		}
+
+		for (int i = 0; i < ArrayLength(threads); ++i)
+		{
+			zpl_thread_join(&threads[i]);
+			zpl_thread_destroy(&threads[i]);
+		}
+	}
+	i64 usedSlotsAfter = zpl_atomic64_load(&UsedThreadSlots);
+	SAssert(usedSlotsAfter == usedSlots);
+
+	// Their caches were flushed, nothing was left behind
+	GeneralPurposeGetStats(&gpa, &stats);
+	SAssert(stats.SlabUsedBytes == stats.SlabCachedBytes);
+	SAssert(stats.SlabCachedBytes == workerCachedBytes);
+
+	GeneralPurposeDestroy(&gpa);
+	SFree(SAllocatorMalloc(), buffer);
+
+	// Virtual allocators only commit the ends that grew
+	GeneralPurposeCreateVirtual(&gpa, Megabytes(64));
+	GeneralPurposeGetStats(&gpa, &stats);
+	SAssert(stats.CommittedBytes == 0);
+
+	u8* small = (u8*)GeneralPurposeAlloc(&gpa, 32);
+	u8* large = (u8*)GeneralPurposeAlloc(&gpa, Kilobytes(200));
+	small[0] = 1;
+	large[Kilobytes(200) - 1] = 1;
+	GeneralPurposeGetStats(&gpa, &stats);
+	SAssert(stats.CommittedBytes > 0 && stats.CommittedBytes < Megabytes(1));
+
+	GeneralPurposeClearAll(&gpa);
+	GeneralPurposeGetStats(&gpa, &stats);
+	SAssert(stats.CommittedBytes == 0);
+
+	GeneralPurposeDestroy(&gpa);
 }
@@ -1,44 +1,145 @@
 #pragma once
 
-#include "Base.h"
-#include "Memory.h"
+#include "Core.h"
 
 #include <inttypes.h>
 
-constant_var size_t GENERALPURPOSE_BUCKET_SIZE = 7;
+// Larger blocks are kept in free lists binned by size, two levels like TLSF:
+// a power of 2 range, then 16 linear steps within it.
+constant_var int GENERALPURPOSE_BIN_SL_LOG2 = 4;
+constant_var int GENERALPURPOSE_BIN_SL_COUNT = 1 << GENERALPURPOSE_BIN_SL_LOG2;
+constant_var int GENERALPURPOSE_BIN_FL_SHIFT = GENERALPURPOSE_BIN_SL_LOG2 + 4;
+constant_var int GENERALPURPOSE_BIN_FL_COUNT = 32 - GENERALPURPOSE_BIN_FL_SHIFT + 1;
 
+// Small allocations (<= 256 bytes) come from 16kb slab pages, one size class per
+// page. Objects have no header, a bitmap in the page tracks which are used.
+constant_var size_t GENERALPURPOSE_SLAB_PAGE_SIZE = Kilobytes(16);
+constant_var size_t GENERALPURPOSE_SLAB_MAX_SIZE = 256;
+constant_var int GENERALPURPOSE_SLAB_CLASS_COUNT = 8;
+constant_var int GENERALPURPOSE_SLAB_BITMAP_WORDS = (int)(GENERALPURPOSE_SLAB_PAGE_SIZE / 16 / 64);
+
+// Per thread caches of slab objects so small allocations from jobs don't take the lock.
+// At most this many threads hold a slot at once, later ones always take the lock.
+// Threads that exit should call GeneralPurposeReleaseThreadSlot, a slot that is never
+// released stays taken and keeps the objects in its caches.
+constant_var int GENERALPURPOSE_MAX_THREADS = 64;
+constant_var int GENERALPURPOSE_MAGAZINE_SIZE = 32;
+
+// Header before every large block. Blocks are next to each other, the one
+// below a block is at (node - PrevSize) and the one above at (node + Size).
 struct MemNode
 {
-    size_t Size;
+    size_t Size;     // Whole block including the header, MEMNODE_* flags in the low bits
+    size_t PrevSize; // Size of the block below, only valid when it's free
+    // Free blocks link their bin in what was the allocation
     MemNode* Next;
     MemNode* Prev;
 };
 
-struct AllocList
+struct SlabPage
+{
+    SlabPage* Next; // Partial list of the class, or free page list
+    SlabPage* Prev;
+    u16 ClassIndex;
+    u16 Count;
+    u16 Capacity; // 0 when the page is in the free page list
+    u64 Used[GENERALPURPOSE_SLAB_BITMAP_WORDS];
+};
+
+struct SlabMagazine
 {
-    MemNode* Head;
-    MemNode* Tail;
-    size_t Length;
+    u32 Count;
+    void* Objects[GENERALPURPOSE_MAGAZINE_SIZE];
 };
 
-// Allocates from an array of FreeLists bases on size. Sizes are
-// ceiled to a power of 2. And aligned with lowest alloc size.
-// Larger values maybe split buckets if they fit nicely, or just take memory from
-// the buffer.
+struct GeneralPurposeThreadCache
+{
+    SlabMagazine Magazines[GENERALPURPOSE_SLAB_CLASS_COUNT];
+};
+
+// Freed blocks are merged with free neighbours right away using the boundary
+// tags in MemNode, then put in the bin for their size. Allocating takes the
+// first block from the smallest non empty bin that fits, found with the bitmaps,
+// or takes memory from the buffer.
+// Slab pages grow up from the start of the buffer while other allocations
+// grow down from the end, memory runs out when they meet. A virtual allocator
+// reserves the buffer and commits both ends as they grow, [Mem, CommitLow)
+// and [CommitHigh, end) are committed.
+// Lock protects everything but ThreadCaches, each thread only touches its own.
 struct GeneralPurposeAllocator
 {
     uintptr_t Mem;
     uintptr_t Offset;
     size_t Size;
-    AllocList Large;
-    AllocList Buckets[GENERALPURPOSE_BUCKET_SIZE];
+    u32 BinFlBitmap;
+    u32 BinSlBitmap[GENERALPURPOSE_BIN_FL_COUNT];
+    MemNode* Bins[GENERALPURPOSE_BIN_FL_COUNT][GENERALPURPOSE_BIN_SL_COUNT];
+    uintptr_t SlabBase;
+    uintptr_t SlabTop;
+    uintptr_t CommitLow;
+    uintptr_t CommitHigh;
+    size_t HighWater; // Most slab and top bytes since the last GeneralPurposeTakeFrameStats
+    bool IsVirtual;
+    SlabPage* SlabPartial[GENERALPURPOSE_SLAB_CLASS_COUNT];
+    SlabPage* SlabFreePages;
+    zpl_mutex Lock;
+    zpl_atomic_ptr RemoteFrees; // Blocks freed while the lock was taken, freed by the next thread to lock
+    GeneralPurposeThreadCache* ThreadCaches[GENERALPURPOSE_MAX_THREADS];
+};
+
+struct GeneralPurposeSlabStats
+{
+    size_t ObjectSize;
+    u32 Pages;
+    u32 Used;
+    u32 Capacity;
+};
+
+struct GeneralPurposeStats
+{
+    GeneralPurposeSlabStats Slabs[GENERALPURPOSE_SLAB_CLASS_COUNT];
+    u32 SlabFreePages;
+    size_t SlabBytes;       // All slab pages, including free ones
+    size_t SlabUsedBytes;   // Live objects times their class size
+    size_t SlabCachedBytes; // Part of SlabUsedBytes sitting in thread caches
+    size_t SlabWasteBytes;  // Page headers, unused slots and free pages
+    size_t LargeUsedBytes;  // Allocated from the top, including headers and rounding
+    size_t LargeFreeBytes;  // In bins, not given back to the top
+    size_t LargeFreeNodes;
+    size_t LargestFreeNode;
+    size_t UnreservedBytes; // Between the slabs and the top allocations
+    size_t CommittedBytes;  // Whole buffer unless virtual
+};
+
+// Cheap enough to take every frame, unlike GeneralPurposeGetStats
+struct GeneralPurposeFrameStats
+{
+    size_t HighWaterBytes; // Slab pages plus top allocations, free blocks in between included
+    size_t CommittedBytes;
 };
 
 void GeneralPurposeCreate(GeneralPurposeAllocator* allocator, void* buffer, size_t bytes);
+// Reserves bytes of address space instead of taking a buffer
+void GeneralPurposeCreateVirtual(GeneralPurposeAllocator* allocator, size_t bytes);
+void GeneralPurposeDestroy(GeneralPurposeAllocator* allocator);
 
+// Safe to call from any thread
 void* GeneralPurposeAlloc(GeneralPurposeAllocator* allocator, size_t bytes);
 void* GeneralPurposeRealloc(GeneralPurposeAllocator* _RESTRICT_ allocator, void* _RESTRICT_ ptr, size_t bytes);
 void GeneralPurposeFree(GeneralPurposeAllocator* _RESTRICT_ allocator, void* _RESTRICT_ ptr);
 void GeneralPurposeClearAll(GeneralPurposeAllocator* allocator);
 
+// Returns the calling thread's cached slab objects
+void GeneralPurposeFlushThreadCache(GeneralPurposeAllocator* allocator);
+// Gives the calling thread's cache slot to later threads, call as it exits after
+// flushing. Objects left in its caches are reused by the next thread given the slot.
+void GeneralPurposeReleaseThreadSlot();
+
 size_t GeneralPurposeGetFreeMemory(GeneralPurposeAllocator* allocator);
+
+void GeneralPurposeGetStats(GeneralPurposeAllocator* allocator, GeneralPurposeStats* outStats);
+// Resets the high water mark to the current use
+void GeneralPurposeTakeFrameStats(GeneralPurposeAllocator* allocator, GeneralPurposeFrameStats* outStats);
+void GeneralPurposeLogReport(GeneralPurposeAllocator* allocator);
+
+void TestGeneralPurposeAllocator();
@@ -29,10 +29,9 @@ struct JobQueue
 	// TODO possibly implement low prio queue
 	//QueueThreaded<Job, JOB_QUEUE_SIZE> LowPriorityQueue;
 
-	_FORCE_INLINE_ void PushBack(const Job& item)
+	_FORCE_INLINE_ bool PushBack(const Job& item)
 	{
-		bool couldEnqueue = HighPriorityQueue.Enqueue(&item);
-		SAssert(couldEnqueue);
+		return HighPriorityQueue.Enqueue(&item);
 	}
 
 	_FORCE_INLINE_ bool PopFront(Job& item)
@@ -52,6 +51,7 @@ struct InternalState
 	JobQueue* JobQueuePerThread;
 	zpl_atomic32 IsAlive;
 	zpl_atomic32 NextQueueIndex;
+	zpl_atomic_ptr ThreadExitCallback; // JobThreadExitFunc
 
 	InternalState()
 	{
@@ -61,6 +61,7 @@ struct InternalState
 		Threads = nullptr;
 		IsAlive = {};
 		NextQueueIndex = {};
+		ThreadExitCallback = {};
 		zpl_atomic32_store(&IsAlive, 1);
 
 		SDebugLog("[ Jobs ] Thread state initialized!");
@@ -81,6 +82,26 @@ struct InternalState
 	}
 } internal_var JobInternalState;
 
+// Runs every job of a group, then counts the group as done
+internal void
+RunJob(const Job& job)
+{
+	SAssert(job.task);
+
+	for (u32 j = job.groupJobOffset; j < job.groupJobEnd; ++j)
+	{
+		JobArgs args;
+		args.GroupId = job.GroupId;
+		args.StackMemory = job.stack;
+		args.JobIndex = j;
+		args.GroupIndex = j - job.groupJobOffset;
+		args.IsFirstJobInGroup = (j == job.groupJobOffset);
+		args.IsLastJobInGroup = (j == job.groupJobEnd - 1);
+		job.task(&args);
+	}
+	zpl_atomic32_fetch_add(&job.handle->Counter, -1);
+}
+
 //	Start working on a job queue
 //	After the job queue is finished, it can switch to an other queue and steal jobs from there
 internal void 
@@ -92,25 +113,23 @@ Work(u32 startingQueue)
 		JobQueue* job_queue = &JobInternalState.JobQueuePerThread[startingQueue % JobInternalState.NumThreads];
 		while (job_queue->PopFront(job))
 		{
-			SAssert(job.task);
-
-			for (u32 j = job.groupJobOffset; j < job.groupJobEnd; ++j)
-			{
-				JobArgs args;
-				args.GroupId = job.GroupId;
-				args.StackMemory = job.stack;
-				args.JobIndex = j;
-				args.GroupIndex = j - job.groupJobOffset;
-				args.IsFirstJobInGroup = (j == job.groupJobOffset);
-				args.IsLastJobInGroup = (j == job.groupJobEnd - 1);
-				job.task(&args);
-			}
-			zpl_atomic32_fetch_add(&job.handle->Counter, -1);
+			RunJob(job);
 		}
 		++startingQueue; // go to next queue
 	}
 }
 
+// A full queue would drop the job and leave its handle busy forever, run it here instead
+internal void
+PushJob(const Job& job)
+{
+	zpl_i32 idx = zpl_atomic32_fetch_add(&JobInternalState.NextQueueIndex, 1) % JobInternalState.NumThreads;
+	if (JobInternalState.JobQueuePerThread[idx].PushBack(job))
+		zpl_semaphore_post(&JobInternalState.Threads[idx].semaphore, 1);
+	else
+		RunJob(job);
+}
+
 void JobsInitialize(u32 maxThreadCount)
 {
 	if (JobInternalState.NumThreads > 0)
@@ -164,6 +183,10 @@ void JobsInitialize(u32 maxThreadCount)
 					zpl_semaphore_wait(&thread->semaphore);
 				}
 
+				JobThreadExitFunc onExit = (JobThreadExitFunc)zpl_atomic_ptr_load(&JobInternalState.ThreadExitCallback);
+				if (onExit)
+					onExit();
+
 				return (zpl_isize)0;
 			}, & threadIdx, sizeof(u32));
 
@@ -211,6 +234,11 @@ u32 JobsGetThreadCount()
 	return JobInternalState.NumThreads;
 }
 
+void JobsSetThreadExitCallback(JobThreadExitFunc onExit)
+{
+	zpl_atomic_ptr_store(&JobInternalState.ThreadExitCallback, (void*)onExit);
+}
+
 void JobsExecute(JobHandle* handle, JobWorkFunc task, void* stack)
 {
 	SAssert(handle);
@@ -227,9 +255,7 @@ void JobsExecute(JobHandle* handle, JobWorkFunc task, void* stack)
 	job.groupJobOffset = 0;
 	job.groupJobEnd = 1;
 
-	zpl_i32 idx = zpl_atomic32_fetch_add(&JobInternalState.NextQueueIndex, 1) % JobInternalState.NumThreads;
-	JobInternalState.JobQueuePerThread[idx].PushBack(job);
-	zpl_semaphore_post(&JobInternalState.Threads[idx].semaphore, 1);
+	PushJob(job);
 }
 
 void JobsDispatch(JobHandle* handle, u32 jobCount, u32 groupSize, JobWorkFunc task, void* stack)
@@ -257,13 +283,16 @@ void JobsDispatch(JobHandle* handle, u32 jobCount, u32 groupSize, JobWorkFunc ta
 		job.GroupId = GroupId;
 		job.groupJobOffset = GroupId * groupSize;
 		job.groupJobEnd = Min(job.groupJobOffset + groupSize, jobCount);
-		
-		zpl_i32 idx = zpl_atomic32_fetch_add(&JobInternalState.NextQueueIndex, 1) % JobInternalState.NumThreads;
-		JobInternalState.JobQueuePerThread[idx].PushBack(job);
-		zpl_semaphore_post(&JobInternalState.Threads[idx].semaphore, 1);
+
+		PushJob(job);
 	}
 }
 
+u32 JobsGetMaxDispatchGroups()
+{
+	return (JOB_QUEUE_SIZE / 2) * JobInternalState.NumThreads;
+}
+
 u32 JobsDispatchGroupCount(u32 jobCount, u32 groupSize)
 {
 	// Calculate the amount of job groups to dispatch (overestimate, or "ceil"):
@@ -18,6 +18,11 @@ struct JobArgs
 
 u32 JobsGetThreadCount();
 
+typedef void(*JobThreadExitFunc)();
+
+// Runs on each worker thread as it exits, after its last job
+void JobsSetThreadExitCallback(JobThreadExitFunc onExit);
+
 // Defines a state of execution, can be waited on
 struct JobHandle
 {
@@ -38,6 +43,10 @@ void JobsDispatch(JobHandle* handle, u32 jobCount, u32 groupSize, JobWorkFunc ta
 // Returns the amount of job groups that will be created for a set number of jobs and group size
 u32 JobsDispatchGroupCount(u32 jobCount, u32 groupSize);
 
+// Most groups one dispatch should make, half of what the job queues hold so
+// other jobs still fit. Groups past a full queue run on the calling thread.
+u32 JobsGetMaxDispatchGroups();
+
 // Check if any threads are working currently or not
 _FORCE_INLINE_ bool
 JobHandleIsBusy(const JobHandle* handle)
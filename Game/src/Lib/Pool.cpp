@@ -1,6 +1,7 @@
 #include "Pool.h"
 
 #include "Memory.h"
+#include "Jobs.h"
 
 #include <inttypes.h>
 
@@ -74,3 +75,183 @@ PoolResizable* PoolResizableCreate(SAllocator allocator, size_t size, size_t num
 
 	return poolResizable;
 }
+
+// Segment header, blocks follow it
+struct PoolConcurrentSegment
+{
+	PoolConcurrentSegment* Next;
+	u8 Padding[DEFAULT_ALIGNMENT - sizeof(PoolConcurrentSegment*)];
+};
+
+void PoolConcurrentCreate(PoolConcurrent* pool, SAllocator allocator, size_t blockSize, u32 blocksPerSegment)
+{
+	SAssert(pool);
+	SAssert(blocksPerSegment > 0);
+
+	*pool = {};
+	pool->BlockSize = (u32)AlignSize(Max(blockSize, sizeof(void*)), DEFAULT_ALIGNMENT);
+	pool->BlocksPerSegment = blocksPerSegment;
+	pool->Allocator = allocator;
+	zpl_mutex_init(&pool->GrowLock);
+}
+
+void PoolConcurrentDestroy(PoolConcurrent* pool)
+{
+	SAssert(pool);
+
+	PoolConcurrentSegment* segment = (PoolConcurrentSegment*)pool->Segments;
+	while (segment)
+	{
+		PoolConcurrentSegment* next = segment->Next;
+		SFree(pool->Allocator, segment);
+		segment = next;
+	}
+	zpl_mutex_destroy(&pool->GrowLock);
+	*pool = {};
+}
+
+bool PoolConcurrentGrow(PoolConcurrent* pool)
+{
+	zpl_mutex_lock(&pool->GrowLock);
+
+	// Another thread grew or freed blocks while this one waited
+	if ((u64)zpl_atomic64_load(&pool->Head) & POOL_CONCURRENT_PTR_MASK)
+	{
+		zpl_mutex_unlock(&pool->GrowLock);
+		return true;
+	}
+
+	size_t size = sizeof(PoolConcurrentSegment) + (size_t)pool->BlockSize * pool->BlocksPerSegment;
+	PoolConcurrentSegment* segment = (PoolConcurrentSegment*)SAllocAlign(pool->Allocator, size, DEFAULT_ALIGNMENT);
+	if (!segment)
+	{
+		zpl_mutex_unlock(&pool->GrowLock);
+		return false;
+	}
+	SAssertMsg(((uintptr_t)segment + size) <= POOL_CONCURRENT_PTR_MASK, "PoolConcurrent needs 48 bit addresses");
+
+	segment->Next = (PoolConcurrentSegment*)pool->Segments;
+	pool->Segments = segment;
+	++pool->SegmentCount;
+
+	u8* first = (u8*)(segment + 1);
+	u8* last = first + (size_t)pool->BlockSize * (pool->BlocksPerSegment - 1);
+	for (u8* block = first; block < last; block += pool->BlockSize)
+		*(void**)block = block + pool->BlockSize;
+
+	PoolConcurrentPush(pool, first, last);
+
+	zpl_mutex_unlock(&pool->GrowLock);
+	return true;
+}
+
+void TestPoolConcurrent()
+{
+	PoolConcurrent pool;
+	PoolConcurrentCreate(&pool, SAllocatorMalloc(), 20, 8);
+	SAssert(pool.BlockSize == 32);
+
+	// Frees are taken first
+	void* a = PoolConcurrentAlloc(&pool);
+	void* b = PoolConcurrentAlloc(&pool);
+	SAssert(a && b && a != b);
+	PoolConcurrentFree(&pool, a);
+	void* reused = PoolConcurrentAlloc(&pool);
+	SAssert(reused == a);
+
+	// Grows past a segment
+	void* blocks[20];
+	for (int i = 0; i < ArrayLength(blocks); ++i)
+	{
+		blocks[i] = PoolConcurrentAlloc(&pool);
+		memset(blocks[i], i, pool.BlockSize);
+	}
+	SAssert(pool.SegmentCount == 3);
+	SAssert(zpl_atomic32_load(&pool.Allocated) == 22);
+
+	PoolConcurrentBatch batch = {};
+	for (int i = 0; i < ArrayLength(blocks); ++i)
+		PoolConcurrentBatchAdd(&batch, blocks[i]);
+	PoolConcurrentFreeBatch(&pool, &batch);
+	PoolConcurrentFree(&pool, a);
+	PoolConcurrentFree(&pool, b);
+	SAssert(zpl_atomic32_load(&pool.Allocated) == 0);
+
+	PoolConcurrentDestroy(&pool);
+	SAssert(pool.Segments == nullptr);
+
+	// Jobs racing to grow an empty pool. A segment is only added once every
+	// block is taken, so the pool ends up exactly big enough
+	constexpr u32 JOB_COUNT = 32;
+	constexpr u32 BLOCKS_PER_JOB = 16;
+	struct ConcurrentTest
+	{
+		PoolConcurrent Pool;
+		u32* Blocks[JOB_COUNT][BLOCKS_PER_JOB];
+	};
+	ConcurrentTest* test = (ConcurrentTest*)SAlloc(SAllocatorMalloc(), sizeof(ConcurrentTest));
+	PoolConcurrentCreate(&test->Pool, SAllocatorMalloc(), 16, 8);
+
+	JobHandle handle = {};
+	JobsDispatch(&handle, JOB_COUNT, 1, [](JobArgs* args)
+				 {
+					 ConcurrentTest* test = (ConcurrentTest*)args->StackMemory;
+					 u32** blocks = test->Blocks[args->JobIndex];
+					 for (u32 i = 0; i < BLOCKS_PER_JOB; ++i)
+					 {
+						 blocks[i] = (u32*)PoolConcurrentAlloc(&test->Pool);
+						 SAssert(blocks[i]);
+						 blocks[i][2] = args->JobIndex * BLOCKS_PER_JOB + i;
+					 }
+				 }, test);
+	JobHandleWait(&handle);
+
+	SAssert(zpl_atomic32_load(&test->Pool.Allocated) == JOB_COUNT * BLOCKS_PER_JOB);
+	SAssert(test->Pool.SegmentCount == JOB_COUNT * BLOCKS_PER_JOB / test->Pool.BlocksPerSegment);
+
+	// A block handed to two jobs would carry the tag of the last writer
+	for (u32 job = 0; job < JOB_COUNT; ++job)
+	{
+		for (u32 i = 0; i < BLOCKS_PER_JOB; ++i)
+			SAssert(test->Blocks[job][i][2] == job * BLOCKS_PER_JOB + i);
+	}
+
+	// Returning blocks singly and in batches while other jobs take them again,
+	// never more than the pool already holds are live so it doesn't grow
+	JobsDispatch(&handle, JOB_COUNT, 1, [](JobArgs* args)
+				 {
+					 ConcurrentTest* test = (ConcurrentTest*)args->StackMemory;
+					 u32** blocks = test->Blocks[args->JobIndex];
+					 if (args->JobIndex % 2)
+					 {
+						 for (u32 i = 0; i < BLOCKS_PER_JOB; ++i)
+							 PoolConcurrentFree(&test->Pool, blocks[i]);
+					 }
+					 else
+					 {
+						 PoolConcurrentBatch batch = {};
+						 for (u32 i = 0; i < BLOCKS_PER_JOB; ++i)
+							 PoolConcurrentBatchAdd(&batch, blocks[i]);
+						 PoolConcurrentFreeBatch(&test->Pool, &batch);
+					 }
+
+					 PoolConcurrentBatch batch = {};
+					 for (u32 i = 0; i < BLOCKS_PER_JOB; ++i)
+					 {
+						 blocks[i] = (u32*)PoolConcurrentAlloc(&test->Pool);
+						 SAssert(blocks[i]);
+						 blocks[i][2] = args->JobIndex;
+						 PoolConcurrentBatchAdd(&batch, blocks[i]);
+					 }
+					 for (u32 i = 0; i < BLOCKS_PER_JOB; ++i)
+						 SAssert(blocks[i][2] == args->JobIndex);
+					 PoolConcurrentFreeBatch(&test->Pool, &batch);
+				 }, test);
+	JobHandleWait(&handle);
+
+	SAssert(zpl_atomic32_load(&test->Pool.Allocated) == 0);
+	SAssert(test->Pool.SegmentCount == JOB_COUNT * BLOCKS_PER_JOB / test->Pool.BlocksPerSegment);
+
+	PoolConcurrentDestroy(&test->Pool);
+	SFree(SAllocatorMalloc(), test);
+}
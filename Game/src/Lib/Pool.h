@@ -121,3 +121,130 @@ inline SAllocatorProc(PoolAllocatorPorc)
 
 	return res;
 }
+
+// Fixed size blocks any thread can take and return without a lock. Free blocks
+// are a stack linked through their first bytes, the head packs a 16 bit tag
+// above a 48 bit pointer and the tag changes on every push and pop, so a block
+// taken and given back between reading the head and swapping it (ABA) fails
+// the compare exchange. Running out adds a segment, which stays until
+// PoolConcurrentDestroy so a stale next pointer is always safe to read.
+constant_var u64 POOL_CONCURRENT_PTR_MASK = (1ull << 48) - 1;
+
+struct PoolConcurrent
+{
+	zpl_atomic64 Head;
+	zpl_atomic32 Allocated; // Blocks handed out
+	void* Segments;         // Linked through their first bytes, GrowLock protects
+	u32 BlockSize;
+	u32 BlocksPerSegment;
+	u32 SegmentCount;
+	zpl_mutex GrowLock;
+	SAllocator Allocator;   // Has to be thread safe if blocks are taken from jobs
+};
+
+// Blocks collected by one thread, given back with a single compare exchange
+struct PoolConcurrentBatch
+{
+	void* First;
+	void* Last;
+	u32 Count;
+};
+
+void PoolConcurrentCreate(PoolConcurrent* pool, SAllocator allocator, size_t blockSize, u32 blocksPerSegment);
+void PoolConcurrentDestroy(PoolConcurrent* pool);
+
+// Adds a segment if the pool is empty, false if the allocator failed
+bool PoolConcurrentGrow(PoolConcurrent* pool);
+
+_FORCE_INLINE_ u64
+PoolConcurrentPack(u64 head, void* block)
+{
+	u64 tag = (head >> 48) + 1;
+	return (tag << 48) | (u64)(uintptr_t)block;
+}
+
+// Links first..last on top of the free stack
+inline void
+PoolConcurrentPush(PoolConcurrent* pool, void* first, void* last)
+{
+	while (true)
+	{
+		u64 head = (u64)zpl_atomic64_load(&pool->Head);
+		*(void**)last = (void*)(uintptr_t)(head & POOL_CONCURRENT_PTR_MASK);
+		u64 newHead = PoolConcurrentPack(head, first);
+		if ((u64)zpl_atomic64_compare_exchange(&pool->Head, (i64)head, (i64)newHead) == head)
+			return;
+	}
+}
+
+inline void*
+PoolConcurrentAlloc(PoolConcurrent* pool)
+{
+	SAssert(pool);
+
+	while (true)
+	{
+		u64 head = (u64)zpl_atomic64_load(&pool->Head);
+		void* block = (void*)(uintptr_t)(head & POOL_CONCURRENT_PTR_MASK);
+		if (!block)
+		{
+			if (!PoolConcurrentGrow(pool))
+			{
+				SError("PoolConcurrent failed to grow");
+				return nullptr;
+			}
+			continue;
+		}
+
+		// Another thread may own block by now, the tag makes the exchange fail
+		void* next = *(void* volatile*)block;
+		u64 newHead = PoolConcurrentPack(head, next);
+		if ((u64)zpl_atomic64_compare_exchange(&pool->Head, (i64)head, (i64)newHead) == head)
+		{
+			zpl_atomic32_fetch_add(&pool->Allocated, 1);
+			return block;
+		}
+	}
+}
+
+inline void
+PoolConcurrentFree(PoolConcurrent* pool, void* block)
+{
+	SAssert(pool);
+
+	if (!block)
+	{
+		SError("PoolConcurrentFree with nullptr block");
+		return;
+	}
+
+	PoolConcurrentPush(pool, block, block);
+	zpl_atomic32_fetch_add(&pool->Allocated, -1);
+}
+
+// Only touches the blocks, no atomics
+inline void
+PoolConcurrentBatchAdd(PoolConcurrentBatch* batch, void* block)
+{
+	SAssert(block);
+	*(void**)block = batch->First;
+	batch->First = block;
+	if (!batch->Last)
+		batch->Last = block;
+	++batch->Count;
+}
+
+inline void
+PoolConcurrentFreeBatch(PoolConcurrent* pool, PoolConcurrentBatch* batch)
+{
+	SAssert(pool);
+
+	if (batch->Count == 0)
+		return;
+
+	PoolConcurrentPush(pool, batch->First, batch->Last);
+	zpl_atomic32_fetch_add(&pool->Allocated, -(i32)batch->Count);
+	*batch = {};
+}
+
+void TestPoolConcurrent();
@@ -0,0 +1,56 @@
+#include "VirtualMemory.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#ifdef _WIN32
+
+void* VirtualMemoryReserve(size_t size)
+{
+	return VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+bool VirtualMemoryCommit(void* ptr, size_t size)
+{
+	return VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+}
+
+void VirtualMemoryDecommit(void* ptr, size_t size)
+{
+	VirtualFree(ptr, size, MEM_DECOMMIT);
+}
+
+void VirtualMemoryRelease(void* ptr, size_t size)
+{
+	VirtualFree(ptr, 0, MEM_RELEASE);
+}
+
+#else
+
+void* VirtualMemoryReserve(size_t size)
+{
+	void* ptr = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	return (ptr == MAP_FAILED) ? nullptr : ptr;
+}
+
+bool VirtualMemoryCommit(void* ptr, size_t size)
+{
+	return mprotect(ptr, size, PROT_READ | PROT_WRITE) == 0;
+}
+
+void VirtualMemoryDecommit(void* ptr, size_t size)
+{
+	// Dropped pages come back zeroed, same as after MEM_DECOMMIT
+	madvise(ptr, size, MADV_DONTNEED);
+	mprotect(ptr, size, PROT_NONE);
+}
+
+void VirtualMemoryRelease(void* ptr, size_t size)
+{
+	munmap(ptr, size);
+}
+
+#endif
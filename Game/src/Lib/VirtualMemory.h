@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stddef.h>
+
+// Reserving only takes address space, pages cost memory once committed.
+// Kept apart from Core.h like JobsWin32, Windows.h and raylib do not mix.
+
+// Ranges are committed in steps of this, the allocation granularity on Windows
+// and a multiple of the page size everywhere.
+#define VIRTUAL_MEMORY_COMMIT_SIZE (64 * 1024)
+
+//! Reserves size bytes of address space, nullptr on failure.
+void* VirtualMemoryReserve(size_t size);
+
+//! Makes pages in a reserved range readable and writable, they read as zero.
+bool VirtualMemoryCommit(void* ptr, size_t size);
+
+//! Gives pages back to the OS, the range stays reserved.
+void VirtualMemoryDecommit(void* ptr, size_t size);
+
+//! Releases a whole range from VirtualMemoryReserve.
+void VirtualMemoryRelease(void* ptr, size_t size);
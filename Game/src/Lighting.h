@@ -110,14 +110,13 @@ struct Slope
 };
 
 _FORCE_INLINE_ bool 
-DoesBlockLight(Vec2i coord)
+DoesBlockLight(TileCursor* cursor, Vec2i coord)
 {
-	Tile* tile = GetTile(&State.MainTileMap, coord);
-	return tile && tile->Flags.Get(TILE_FLAG_BLOCKS_LIGHT);
+	return TileCursorIsBlockingLight(cursor, coord);
 }
 
 internal void
-ProcessOctants(Light* light, int radius, u8 octant, int x, Slope top, Slope bottom)
+ProcessOctants(Light* light, TileCursor* cursor, int radius, u8 octant, int x, Slope top, Slope bottom)
 {
 	for (; x <= radius; ++x) // rangeLimit < 0 || x <= rangeLimit
 	{
@@ -155,7 +154,7 @@ ProcessOctants(Light* light, int radius, u8 octant, int x, Slope top, Slope bott
 			// NOTE: use the next line instead if you want the algorithm to be symmetrical
 			// if(inRange && (y != topY || top.Y*x >= top.X*y) && (y != bottomY || bottom.Y*x <= bottom.X*y)) SetVisible(tx, ty);
 
-			bool isOpaque = !inRange || DoesBlockLight(txty);
+			bool isOpaque = !inRange || DoesBlockLight(cursor, txty);
 			if (x != radius)
 			{
 				if (isOpaque)
@@ -164,7 +163,7 @@ ProcessOctants(Light* light, int radius, u8 octant, int x, Slope top, Slope bott
 					{                  // adjust the bottom vector upwards and continue processing it in the next column.
 						Slope newBottom = { y * 2 + 1, x * 2 - 1 }; // (x*2-1, y*2+1) is a vector to the top-left of the opaque tile
 						if (!inRange || y == bottomY) { bottom = newBottom; break; } // don't recurse unless we have to
-						else ProcessOctants(light, radius, octant, x + 1, top, newBottom);
+						else ProcessOctants(light, cursor, radius, octant, x + 1, top, newBottom);
 					}
 					wasOpaque = 1;
 				}
@@ -193,9 +192,10 @@ UpdateLight(Light* light)
 	LightMapState.Colors.At(idx)->b += light->Color.b;
 	LightMapState.Colors.At(idx)->a += light->Color.a;
 
+	TileCursor cursor = TileCursorCreate(&State.MainTileMap);
 	int radius = light->Radius;
 	for (u8 octant = 0; octant < 8; ++octant)
 	{
-		ProcessOctants(light, radius, octant, 1, { 1, 1 }, { 0, 1 });
+		ProcessOctants(light, &cursor, radius, octant, 1, { 1, 1 }, { 0, 1 });
 	}
 }
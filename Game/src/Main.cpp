@@ -4,12 +4,21 @@
 #define FNL_IMPL
 #include <FastNoiseLite/FastNoiseLite.h>
 
+#if SCAL_HEADLESS
+// Defined in Headless.cpp
+extern int HeadlessMain(int argCount, char** args);
+#else
 // Defined in GameState.cpp
 extern int GameInitialize();
+#endif
 
 int
 main(int argCount, char** args)
 {
+#if SCAL_HEADLESS
+	int result = HeadlessMain(argCount, args);
+#else
 	int result = GameInitialize();
+#endif
 	return result;
 }
\ No newline at end of file
@@ -1,14 +1,35 @@
 #include "Memory.h"
 
 #include "GameState.h"
+#include "Scratch.h"
 #include "Structures/HashMapT.h"
+#include "Lib/Jobs.h"
 
 #if TRACK_MEMORY
+// Slots are claimed by a compare exchange on Key and never given back
+constant_var u32 MEMORY_CALLSITE_CAPACITY = 4096;
+constant_var u32 MEMORY_CALLSITE_MAX_PROBES = 64;
+constant_var int MEMORY_CALLSITE_MAX_LOG = 64;
+
+struct MemoryCallsite
+{
+	zpl_atomic64 Key; // 0 while unused
+	zpl_atomic_ptr File; // Published after Function and Line, null until then
+	const char* Function;
+	int Line;
+	zpl_atomic64 Count;
+	zpl_atomic64 Bytes;
+	// Only sampled allocations, times TRACK_MEMORY_SAMPLE_RATE for an estimate
+	zpl_atomic64 SampledLiveBytes;
+	zpl_atomic64 SampledPeakBytes;
+};
+
 struct MemoryInfo
 {
 	size_t Size;
 	const char* File;
 	const char* Function;
+	MemoryCallsite* Callsite;
 	int Line;
 	int ResizeTracker;
 	bool IsIgnoringFree;
@@ -16,26 +37,158 @@ struct MemoryInfo
 
 struct MemoryInfoState
 {
+	MemoryCallsite Callsites[MEMORY_CALLSITE_CAPACITY];
+	zpl_atomic64 CallsiteOverflow; // Allocations that found no free slot
+	// Sampled allocations only
 	HashMapT<void*, MemoryInfo> AllocationMap[(int)SAllocatorId::Max];
+	bool IsInitialized;
+	zpl_mutex Lock;
+};
+internal_var MemoryInfoState MemoryState;
+
+// An AllocationMap growing while a map's resize is tracked pushes over it
+constant_var int MEMORY_POINTER_STACK_SIZE = 4;
+
+// Pushes only apply to the thread that made them, jobs allocate while the main thread has its own
+struct MemoryThreadState
+{
 	const char* AdditionalFile;
 	const char* AdditionalFunction;
 	int AdditionalLine;
-	void* SearchMemoryAddress;
+	void* SearchMemoryAddresses[MEMORY_POINTER_STACK_SIZE];
+	int SearchMemoryAddressCount;
 	int IsIgnoringFree;
-	bool IsInitialized;
 };
-internal_var MemoryInfoState MemoryState;
+thread_local internal_var MemoryThreadState ThreadMemoryState;
+
+// Resizing an AllocationMap tracks its own allocation on the same thread, only the outer call locks
+thread_local internal_var int TrackingDepth;
+
+internal _FORCE_INLINE_ void*
+GetSearchMemoryAddress()
+{
+	int count = ThreadMemoryState.SearchMemoryAddressCount;
+	return (count > 0) ? ThreadMemoryState.SearchMemoryAddresses[count - 1] : nullptr;
+}
 
 constant_var const char* ALLOCATOR_NAMES[] =
 {
 	"General Purpose",
 	"Frame",
 	"Malloc",
-	"Arena"
+	"Arena",
+	"Two Frame"
 };
 
 #endif
 
+internal_var MemoryHistory FrameHistory;
+internal_var zpl_atomic32 FrameAllocCounts[(int)SAllocatorId::Max];
+internal_var zpl_atomic32 FrameFreeCounts[(int)SAllocatorId::Max];
+
+constant_var const char* ALLOCATOR_CSV_NAMES[] =
+{
+	"general",
+	"frame",
+	"malloc",
+	"arena",
+	"two_frame"
+};
+static_assert(ArrayLength(ALLOCATOR_CSV_NAMES) == (int)SAllocatorId::Max);
+
+internal _FORCE_INLINE_ void
+CountAllocation(SAllocatorId allocatorId, SAllocatorType allocatorType)
+{
+	// Allocators are used from job threads
+	if (allocatorType == ALLOCATOR_TYPE_FREE)
+		zpl_atomic32_fetch_add(&FrameFreeCounts[(int)allocatorId], 1);
+	else
+		zpl_atomic32_fetch_add(&FrameAllocCounts[(int)allocatorId], 1);
+}
+
+// Returns the high water of the arena that took pushes during the frame that ended
+internal size_t
+SwapFrameArenas(TwoFrameArenas* frameArenas)
+{
+	// The arena taking pushes now holds the frame before last, its results
+	// were consumed this frame
+	zpl_mutex_lock(&frameArenas->Lock);
+	size_t highWater = frameArenas->Arenas[frameArenas->Index].HighWater;
+	frameArenas->Index ^= 1;
+	ArenaClear(&frameArenas->Arenas[frameArenas->Index]);
+	ArenaResetHighWater(&frameArenas->Arenas[frameArenas->Index]);
+	zpl_mutex_unlock(&frameArenas->Lock);
+	return highWater;
+}
+
+void MemoryEndFrame()
+{
+	MemoryFrameStats* stats = &FrameHistory.Frames[FrameHistory.FrameCount % MEMORY_HISTORY_LENGTH];
+	stats->Frame = FrameHistory.FrameCount;
+
+	stats->TransientHighWater = TransientState.TransientArena.HighWater;
+	ArenaResetHighWater(&TransientState.TransientArena);
+
+	stats->GameArenaHighWater = GetGameState()->GameArena.HighWater;
+	ArenaResetHighWater(&GetGameState()->GameArena);
+	stats->GameArenaUsed = GetGameState()->GameArena.TotalAllocated;
+	stats->GameArenaCommitted = GetGameState()->GameArena.Committed;
+
+	GeneralPurposeFrameStats gpaStats;
+	GeneralPurposeTakeFrameStats(&GetGameState()->GeneralPurposeMemory, &gpaStats);
+	stats->GeneralPurposeHighWater = gpaStats.HighWaterBytes;
+	stats->GeneralPurposeCommitted = gpaStats.CommittedBytes;
+
+	for (int i = 0; i < (int)SAllocatorId::Max; ++i)
+	{
+		stats->Allocs[i] = (u32)zpl_atomic32_exchange(&FrameAllocCounts[i], 0);
+		stats->Frees[i] = (u32)zpl_atomic32_exchange(&FrameFreeCounts[i], 0);
+	}
+
+	++FrameHistory.FrameCount;
+
+	stats->FrameArenaHighWater = SwapFrameArenas(&TransientState.FrameArenas);
+	ScratchCheckLeaks();
+}
+
+const MemoryHistory* GetMemoryHistory()
+{
+	return &FrameHistory;
+}
+
+bool MemoryHistoryWriteCsv(const char* path)
+{
+	zpl_file file;
+	zpl_file_error err = zpl_file_create(&file, path);
+	if (err)
+	{
+		SWarn("Could not create %s, error id: %d", path, (int)err);
+		return false;
+	}
+
+	zpl_fprintf(&file, "frame,transient_high_water,frame_arena_high_water,game_arena_high_water,game_arena_used,game_arena_committed,"
+				"general_purpose_high_water,general_purpose_committed");
+	for (int i = 0; i < (int)SAllocatorId::Max; ++i)
+		zpl_fprintf(&file, ",%s_allocs,%s_frees", ALLOCATOR_CSV_NAMES[i], ALLOCATOR_CSV_NAMES[i]);
+	zpl_fprintf(&file, "\n");
+
+	u64 count = Min(FrameHistory.FrameCount, (u64)MEMORY_HISTORY_LENGTH);
+	for (u64 frame = FrameHistory.FrameCount - count; frame < FrameHistory.FrameCount; ++frame)
+	{
+		MemoryFrameStats* stats = &FrameHistory.Frames[frame % MEMORY_HISTORY_LENGTH];
+		zpl_fprintf(&file, "%llu,%zu,%zu,%zu,%zu,%zu,%zu,%zu", (unsigned long long)stats->Frame,
+					stats->TransientHighWater, stats->FrameArenaHighWater, stats->GameArenaHighWater,
+					stats->GameArenaUsed, stats->GameArenaCommitted,
+					stats->GeneralPurposeHighWater, stats->GeneralPurposeCommitted);
+		for (int i = 0; i < (int)SAllocatorId::Max; ++i)
+			zpl_fprintf(&file, ",%u,%u", stats->Allocs[i], stats->Frees[i]);
+		zpl_fprintf(&file, "\n");
+	}
+
+	zpl_file_close(&file);
+	return true;
+}
+
 void InitializeMemoryTracking()
 {
 #if TRACK_MEMORY
@@ -51,6 +204,7 @@ void InitializeMemoryTracking()
 
 		HashMapTInitialize(&MemoryState.AllocationMap[i], 1024, SAllocatorMalloc());
 	}
+	zpl_mutex_init(&MemoryState.Lock);
 	MemoryState.IsInitialized = true;
 #endif
 }
@@ -63,11 +217,16 @@ void ShutdownMemoryTracking()
 		SError("MemoryState not initialized");
 	}
 
-	if (MemoryState.IsIgnoringFree != 0)
+	if (ThreadMemoryState.IsIgnoringFree != 0)
 	{
 		SError("MemoryState.IsIgnoreingFree stack value is not 0!");
 	}
 
+	if (TRACK_MEMORY_SAMPLE_RATE > 1)
+	{
+		SDebugLog("[ Memory ] Leak check only covers 1 in %d sampled allocations", TRACK_MEMORY_SAMPLE_RATE);
+	}
+
 	MemoryState.IsInitialized = false;
 
 	for (int i = 0; i < (int)SAllocatorId::Max; ++i)
@@ -91,123 +250,279 @@ void ShutdownMemoryTracking()
 #endif
 }
 
+internal MemoryCallsite*
+GetCallsite(const char* file, const char* function, int line)
+{
+	u64 key = HashMix64((u64)(uintptr_t)file ^ ((u64)(u32)line << 48));
+	// 0 marks an empty slot, remapped rather than masked so the low bit still spreads keys
+	if (key == 0)
+		key = 1;
+	for (u32 probe = 0; probe < MEMORY_CALLSITE_MAX_PROBES; ++probe)
+	{
+		MemoryCallsite* callsite = &MemoryState.Callsites[(key + probe) & (MEMORY_CALLSITE_CAPACITY - 1)];
+		i64 slotKey = zpl_atomic64_load(&callsite->Key);
+		if (slotKey == 0)
+		{
+			slotKey = zpl_atomic64_compare_exchange(&callsite->Key, 0, (i64)key);
+			if (slotKey == 0)
+			{
+				callsite->Function = function;
+				callsite->Line = line;
+				zpl_atomic_ptr_store(&callsite->File, (void*)file);
+				return callsite;
+			}
+		}
+
+		if ((u64)slotKey == key)
+			return callsite;
+	}
+	return nullptr;
+}
+
 internal void
-HandleMemoryTracking(int allocatorId, SAllocatorType allocatorType, void* oldPtr, size_t oldSize,
-					 void* newPtr, size_t newSize, const char* file, const char* function, int line)
+CallsiteAddLive(MemoryCallsite* callsite, i64 bytes)
 {
-	if (MemoryState.IsInitialized)
+	if (!callsite)
+		return;
+
+	i64 live = zpl_atomic64_fetch_add(&callsite->SampledLiveBytes, bytes) + bytes;
+	i64 peak = zpl_atomic64_load(&callsite->SampledPeakBytes);
+	while (live > peak)
+	{
+		i64 prev = zpl_atomic64_compare_exchange(&callsite->SampledPeakBytes, peak, live);
+		if (prev == peak)
+			break;
+		peak = prev;
+	}
+}
+
+// Decided by address so a free knows if its allocation was sampled without a lookup
+internal _FORCE_INLINE_ bool
+IsSampled(void* ptr)
+{
+#if TRACK_MEMORY_SAMPLE_RATE
+	return ptr && (HashMix64((u64)(uintptr_t)ptr) % TRACK_MEMORY_SAMPLE_RATE) == 0;
+#else
+	return false;
+#endif
+}
+
+internal void
+TrackAllocation(int allocatorId, SAllocatorType allocatorType, void* oldPtr, size_t oldSize,
+				void* newPtr, size_t newSize, MemoryCallsite* callsite, const char* file, const char* function, int line)
+{
+	// Free we just remove from map
+	if (allocatorType == ALLOCATOR_TYPE_FREE)
 	{
-		// Free we just remove from map
-		if (allocatorType == ALLOCATOR_TYPE_FREE)
+		SAssert(oldPtr);
+		MemoryInfo* info = HashMapTGet(&MemoryState.AllocationMap[allocatorId], &oldPtr);
+		if (info)
 		{
-			SAssert(oldPtr);
+			CallsiteAddLive(info->Callsite, -(i64)info->Size);
 			HashMapTRemove(&MemoryState.AllocationMap[allocatorId], &oldPtr);
 		}
-		else
+	}
+	else
+	{
+		MemoryInfo memInfo;	// Info to insert
+		MemoryInfo* oldInfo = nullptr; // Was any old entry found
+		void* searchAddress = GetSearchMemoryAddress();
+		if (oldPtr)
 		{
-			MemoryInfo memInfo;	// Info to insert
-			MemoryInfo* oldInfo = nullptr; // Was any old entry found
-			if (oldPtr)
+			oldInfo = HashMapTGet(&MemoryState.AllocationMap[allocatorId], &oldPtr);
+			if (oldInfo)
 			{
-				oldInfo = HashMapTGet(&MemoryState.AllocationMap[allocatorId], &oldPtr);
-				if (oldInfo)
-				{
-					memInfo = *oldInfo;
-					// Remove old info
-					HashMapTRemove(&MemoryState.AllocationMap[allocatorId], &oldPtr);
-				}
-			}
-			// NOTE: Certain reallocations may not free realloc and instead alloc then free later,
-			// in this case we want to search for previous allocations and also not remove any old allocations.
-			// HashMap::Resize is a function that does this.
-			else if (MemoryState.SearchMemoryAddress)
-			{
-				oldInfo = HashMapTGet(&MemoryState.AllocationMap[allocatorId], &MemoryState.SearchMemoryAddress);
-				// Handles the case where the hashmap for storing allocations resizes
-				// since those hashmaps don't exist yet to store their own allocation
-				if (!oldInfo) 
-					return;
-				else
-					memInfo = *oldInfo;
+				memInfo = *oldInfo;
+				CallsiteAddLive(memInfo.Callsite, -(i64)memInfo.Size);
+				// Remove old info
+				HashMapTRemove(&MemoryState.AllocationMap[allocatorId], &oldPtr);
 			}
+		}
+		// NOTE: Certain reallocations may not free realloc and instead alloc then free later,
+		// in this case we want to search for previous allocations and also not remove any old allocations.
+		// HashMap::Resize is a function that does this.
+		else if (searchAddress)
+		{
+			oldInfo = HashMapTGet(&MemoryState.AllocationMap[allocatorId], &searchAddress);
+			// Handles the case where the hashmap for storing allocations resizes
+			// since those hashmaps don't exist yet to store their own allocation
+			if (!oldInfo) 
+				return;
+			else
+				memInfo = *oldInfo;
+		}
 
-			if (!oldInfo)
-				memInfo = {};
+		// Only the old pointer was sampled
+		if (!IsSampled(newPtr))
+			return;
 
-			memInfo.Size = newSize;
-			if (!oldInfo)
-			{
-				memInfo.File = file;
-				memInfo.Function = function;
-				memInfo.Line = line;
-				memInfo.IsIgnoringFree = MemoryState.IsIgnoringFree;
-				memInfo.ResizeTracker = 0;
-			}
-			else 
-			{
-				// Already exists just reuse it's data.
-				memInfo.ResizeTracker += 1;
-			}
-			HashMapTSet(&MemoryState.AllocationMap[allocatorId], &newPtr, &memInfo);
+		if (!oldInfo)
+			memInfo = {};
+
+		memInfo.Size = newSize;
+		if (!oldInfo)
+		{
+			memInfo.File = file;
+			memInfo.Function = function;
+			memInfo.Callsite = callsite;
+			memInfo.Line = line;
+			memInfo.IsIgnoringFree = ThreadMemoryState.IsIgnoringFree;
+			memInfo.ResizeTracker = 0;
 		}
+		else 
+		{
+			// Already exists just reuse it's data.
+			memInfo.ResizeTracker += 1;
+		}
+		CallsiteAddLive(memInfo.Callsite, (i64)newSize);
+		HashMapTSet(&MemoryState.AllocationMap[allocatorId], &newPtr, &memInfo);
+	}
+}
+
+internal void
+HandleMemoryTracking(int allocatorId, SAllocatorType allocatorType, void* oldPtr, size_t oldSize,
+					 void* newPtr, size_t newSize, const char* file, const char* function, int line)
+{
+	if (!MemoryState.IsInitialized)
+		return;
+
+	MemoryCallsite* callsite = nullptr;
+	if (allocatorType != ALLOCATOR_TYPE_FREE)
+	{
+		callsite = GetCallsite(file, function, line);
+		if (callsite)
+		{
+			zpl_atomic64_fetch_add(&callsite->Count, 1);
+			zpl_atomic64_fetch_add(&callsite->Bytes, (i64)newSize);
+		}
+		else
+		{
+			zpl_atomic64_fetch_add(&MemoryState.CallsiteOverflow, 1);
+		}
+	}
+
+	// Most allocations stop here, only sampled ones take the lock
+	if (!IsSampled(oldPtr) && !IsSampled(newPtr)
+		&& (oldPtr || !IsSampled(GetSearchMemoryAddress())))
+		return;
+
+	// Allocators can be used from job threads
+	if (TrackingDepth++ == 0)
+		zpl_mutex_lock(&MemoryState.Lock);
+
+	TrackAllocation(allocatorId, allocatorType, oldPtr, oldSize, newPtr, newSize, callsite, file, function, line);
+
+	if (--TrackingDepth == 0)
+		zpl_mutex_unlock(&MemoryState.Lock);
+}
+
+void LogMemoryCallsites(int count)
+{
+#if TRACK_MEMORY
+	count = ClampValue(count, 1, MEMORY_CALLSITE_MAX_LOG);
+
+	// Keeps the largest by bytes, sorted
+	MemoryCallsite* top[MEMORY_CALLSITE_MAX_LOG];
+	int topCount = 0;
+	for (u32 i = 0; i < MEMORY_CALLSITE_CAPACITY; ++i)
+	{
+		MemoryCallsite* callsite = &MemoryState.Callsites[i];
+		if (!zpl_atomic_ptr_load(&callsite->File))
+			continue;
+
+		i64 bytes = zpl_atomic64_load(&callsite->Bytes);
+		int index = topCount;
+		while (index > 0 && zpl_atomic64_load(&top[index - 1]->Bytes) < bytes)
+			--index;
+
+		if (index >= count)
+			continue;
+
+		int last = Min(topCount, count - 1);
+		for (int j = last; j > index; --j)
+			top[j] = top[j - 1];
+		top[index] = callsite;
+		topCount = Min(topCount + 1, count);
+	}
+
+	SInfoLog("[ Memory ] Top %d allocation callsites, live and peak are estimated from 1 in %d allocations",
+			 topCount, TRACK_MEMORY_SAMPLE_RATE);
+	for (int i = 0; i < topCount; ++i)
+	{
+		MemoryCallsite* callsite = top[i];
+		SInfoLog("[ Memory ]   %s:%d (%s): %lld allocs, %lldkb total, ~%lldkb live, ~%lldkb peak",
+				 (const char*)zpl_atomic_ptr_load(&callsite->File), callsite->Line, callsite->Function,
+				 (long long)zpl_atomic64_load(&callsite->Count),
+				 (long long)zpl_atomic64_load(&callsite->Bytes) / 1024,
+				 (long long)zpl_atomic64_load(&callsite->SampledLiveBytes) * TRACK_MEMORY_SAMPLE_RATE / 1024,
+				 (long long)zpl_atomic64_load(&callsite->SampledPeakBytes) * TRACK_MEMORY_SAMPLE_RATE / 1024);
 	}
+
+	i64 overflow = zpl_atomic64_load(&MemoryState.CallsiteOverflow);
+	if (overflow > 0)
+	{
+		SInfoLog("[ Memory ] %lld allocations had no free callsite slot", (long long)overflow);
+	}
+#endif
 }
 
 void Internal_PushMemoryIgnoreFree()
 {
 #if TRACK_MEMORY
-	++MemoryState.IsIgnoringFree;
+	++ThreadMemoryState.IsIgnoringFree;
 #endif
 }
 
 void Internal_PopMemoryIgnoreFree()
 {
 #if TRACK_MEMORY
-	if (!MemoryState.IsIgnoringFree)
+	if (!ThreadMemoryState.IsIgnoringFree)
 	{
 		SWarn("PopMemoryIgnoreFree when already 0");
 	}
 
-	--MemoryState.IsIgnoringFree;
+	--ThreadMemoryState.IsIgnoringFree;
 #endif
 }
 
 void Internal_PushMemoryAdditionalInfo(const char* file, const char* func, int line)
 {
 #if TRACK_MEMORY
-	MemoryState.AdditionalFile = file;
-	MemoryState.AdditionalFunction = func;
-	MemoryState.AdditionalLine = line;
+	ThreadMemoryState.AdditionalFile = file;
+	ThreadMemoryState.AdditionalFunction = func;
+	ThreadMemoryState.AdditionalLine = line;
 #endif
 }
 
 void Internal_PopMemoryAdditionalInfo()
 {
 #if TRACK_MEMORY
-	MemoryState.AdditionalFile = nullptr;
-	MemoryState.AdditionalFunction = nullptr;
-	MemoryState.AdditionalLine = 0;
+	ThreadMemoryState.AdditionalFile = nullptr;
+	ThreadMemoryState.AdditionalFunction = nullptr;
+	ThreadMemoryState.AdditionalLine = 0;
 #endif
 }
 
 void Internal_PushMemoryPointer(void* address)
 {
 #if TRACK_MEMORY
-	if (MemoryState.SearchMemoryAddress)
+	if (ThreadMemoryState.SearchMemoryAddressCount == MEMORY_POINTER_STACK_SIZE)
 	{
-		SError("Already pushed memory pointer!");
+		SError("Too many memory pointers pushed!");
+		return;
 	}
-	MemoryState.SearchMemoryAddress = address;
+	ThreadMemoryState.SearchMemoryAddresses[ThreadMemoryState.SearchMemoryAddressCount++] = address;
 #endif
 }
 void Internal_PopMemoryPointer()
 {
 #if TRACK_MEMORY
-	if (!MemoryState.SearchMemoryAddress)
+	if (ThreadMemoryState.SearchMemoryAddressCount == 0)
 	{
 		SError("No memory pointer to pop!");
+		return;
 	}
-	MemoryState.SearchMemoryAddress = nullptr;
+	--ThreadMemoryState.SearchMemoryAddressCount;
 #endif
 }
 
@@ -243,6 +558,8 @@ SAllocatorProc(GameAllocatorProc)
 		SAssert(res);
 #endif
 
+	CountAllocation(SAllocatorId::General, allocatorType);
+
 #if TRACK_MEMORY
 	HandleMemoryTracking((int)SAllocatorId::General, allocatorType, ptr, oldSize, res, newSize, file, func, line);
 #endif
@@ -288,6 +605,52 @@ SAllocatorProc(FrameAllocatorProc)
 	}
 #endif
 
+	CountAllocation(SAllocatorId::Frame, allocatorType);
+
+	return res;
+}
+
+SAllocatorProc(TwoFrameAllocatorProc)
+{
+	// Data is only set by tests, the game uses the transient state's pair
+	TwoFrameArenas* frameArenas = (data) ? (TwoFrameArenas*)data : &TransientState.FrameArenas;
+	void* res;
+
+	switch (allocatorType)
+	{
+	case (ALLOCATOR_TYPE_MALLOC):
+	case (ALLOCATOR_TYPE_REALLOC):
+	{
+		zpl_mutex_lock(&frameArenas->Lock);
+		res = ArenaPush(&frameArenas->Arenas[frameArenas->Index], newSize);
+		zpl_mutex_unlock(&frameArenas->Lock);
+
+		if (ptr && res)
+		{
+			SCopy(res, ptr, Min(oldSize, newSize));
+		}
+	} break;
+
+	case (ALLOCATOR_TYPE_FREE):
+	{
+		// Cleared when the arena comes back around, two frames later
+		res = nullptr;
+	} break;
+
+	default:
+		SError("Invalid SAllocator type");
+		res = nullptr;
+	}
+
+#if SCAL_DEBUG
+	if (allocatorType != ALLOCATOR_TYPE_FREE)
+	{
+		SAssert(res);
+	}
+#endif
+
+	CountAllocation(SAllocatorId::TwoFrame, allocatorType);
+
 	return res;
 }
 
@@ -323,6 +686,8 @@ SAllocatorProc(MallocAllocatorProc)
 		SAssert(res);
 #endif
 
+	CountAllocation(SAllocatorId::Malloc, allocatorType);
+
 #if TRACK_MEMORY
 	HandleMemoryTracking((int)SAllocatorId::Malloc, allocatorType, ptr, oldSize, res, newSize, file, func, line);
 #endif
@@ -369,6 +734,79 @@ SAllocatorProc(ArenaAllocatorProc)
 	if (allocatorType != ALLOCATOR_TYPE_FREE)
 		SAssert(res);
 #endif
+
+	CountAllocation(SAllocatorId::Arena, allocatorType);
+
 	return res;
 }
 
+
+void TestTwoFrameAllocator()
+{
+	// Swapping the game's pair would clear results handed to the next frame
+	TwoFrameArenas frameArenas = {};
+	ArenaCreateFromAllocator(&frameArenas.Arenas[0], SAllocatorMalloc(), Kilobytes(4));
+	ArenaCreateFromAllocator(&frameArenas.Arenas[1], SAllocatorMalloc(), Kilobytes(4));
+	zpl_mutex_init(&frameArenas.Lock);
+	SAllocator allocator = { TwoFrameAllocatorProc, &frameArenas };
+	Arena* first = &frameArenas.Arenas[0];
+
+	int* a = (int*)SAlloc(allocator, sizeof(int) * 4);
+	a[0] = 10;
+	SAssert(first->TotalAllocated > 0);
+
+	// Next frame pushes to the other arena, a is still valid
+	size_t highWater = SwapFrameArenas(&frameArenas);
+	SAssert(highWater == first->TotalAllocated);
+	SAssert(frameArenas.Index == 1);
+	int* b = (int*)SAlloc(allocator, sizeof(int) * 4);
+	b[0] = 20;
+	SAssert(a[0] == 10);
+	SAssert(first->TotalAllocated > 0);
+
+	// The frame after gets the first arena back, cleared
+	SwapFrameArenas(&frameArenas);
+	SAssert(frameArenas.Index == 0);
+	SAssert(first->TotalAllocated == 0);
+	SAssert(b[0] == 20);
+
+	ArenaFree(&frameArenas.Arenas[0]);
+	ArenaFree(&frameArenas.Arenas[1]);
+	zpl_mutex_destroy(&frameArenas.Lock);
+}
+
+void TestMemoryTrackingThreaded()
+{
+#if TRACK_MEMORY
+	SAssert(MemoryState.IsInitialized);
+	HashMapT<void*, MemoryInfo>* generalMap = &MemoryState.AllocationMap[(int)SAllocatorId::General];
+	zpl_mutex_lock(&MemoryState.Lock);
+	u32 trackedCount = generalMap->Count;
+	zpl_mutex_unlock(&MemoryState.Lock);
+
+	// Maps growing from their smallest size on every worker, each resize pushes
+	// a memory pointer while the others allocate
+	JobHandle handle = {};
+	JobsDispatch(&handle, 32, 1, [](JobArgs* args)
+				 {
+					 HashMapT<u64, u64> map;
+					 HashMapTInitialize(&map, 4, SAllocatorGeneral());
+					 for (u64 i = 0; i < 2048; ++i)
+					 {
+						 u64 key = i * 31 + args->JobIndex;
+						 HashMapTSet(&map, &key, &i);
+					 }
+					 SAssert(map.Count == 2048);
+					 HashMapTDestroy(&map);
+					 SAssert(ThreadMemoryState.SearchMemoryAddressCount == 0);
+				 }, nullptr);
+	JobHandleWait(&handle);
+
+	// Everything the jobs allocated was freed, no sampled record may be left
+	zpl_mutex_lock(&MemoryState.Lock);
+	u32 trackedCountAfter = generalMap->Count;
+	zpl_mutex_unlock(&MemoryState.Lock);
+	SAssert(trackedCountAfter == trackedCount);
+	SAssert(ThreadMemoryState.SearchMemoryAddressCount == 0);
+#endif
+}
@@ -2,7 +2,12 @@
 
 #include "Base.h"
 
+// Counts allocations per callsite (file/line) in a lock free table, cheap
+// enough to leave on. 1 in TRACK_MEMORY_SAMPLE_RATE allocations also keep a
+// full record for leak reports and live estimates, 1 records every allocation
+// and 0 none.
 #define TRACK_MEMORY 1
+#define TRACK_MEMORY_SAMPLE_RATE 64
 
 enum class SAllocatorId : int
 {
@@ -10,6 +15,7 @@ enum class SAllocatorId : int
 	Frame,
 	Malloc,
 	Arena,
+	TwoFrame,
 
 	Max
 };
@@ -55,12 +61,16 @@ SAllocatorProc(GameAllocatorProc);
 
 SAllocatorProc(FrameAllocatorProc);
 
+SAllocatorProc(TwoFrameAllocatorProc);
+
 SAllocatorProc(MallocAllocatorProc);
 
 SAllocatorProc(ArenaAllocatorProc);
 
 #define SAllocatorGeneral() (SAllocator{ GameAllocatorProc, nullptr })
 #define SAllocatorFrame() (SAllocator{ FrameAllocatorProc, nullptr })
+// Lives until the end of the next frame, safe from jobs
+#define SAllocatorTwoFrame() (SAllocator{ TwoFrameAllocatorProc, nullptr })
 #define SAllocatorMalloc() (SAllocator{ MallocAllocatorProc, nullptr })
 #define SAllocatorArena(arena) (SAllocator{ ArenaAllocatorProc, arena })
 
@@ -83,9 +93,48 @@ SAllocatorProc(ArenaAllocatorProc);
 #define SMemMove(dst, src, sz) memmove(dst, src, sz)
 #define SZero(ptr, sz) memset(ptr, 0, sz)
 
+// Memory use of each frame, the last MEMORY_HISTORY_LENGTH frames are kept
+constant_var int MEMORY_HISTORY_LENGTH = 256;
+
+struct MemoryFrameStats
+{
+	u64 Frame;
+	size_t TransientHighWater;
+	size_t FrameArenaHighWater; // Of the arena that took this frame's two-frame pushes
+	size_t GameArenaHighWater;
+	size_t GameArenaUsed;
+	size_t GameArenaCommitted;
+	size_t GeneralPurposeHighWater;
+	size_t GeneralPurposeCommitted;
+	u32 Allocs[(int)SAllocatorId::Max]; // Mallocs and reallocs
+	u32 Frees[(int)SAllocatorId::Max];
+};
+
+struct MemoryHistory
+{
+	MemoryFrameStats Frames[MEMORY_HISTORY_LENGTH];
+	u64 FrameCount; // Latest frame is at (FrameCount - 1) % MEMORY_HISTORY_LENGTH
+};
+
+// Records the frame and resets high water marks and counts, then swaps the two
+// frame arenas, once per frame
+void MemoryEndFrame();
+
+void TestTwoFrameAllocator();
+// Dispatches jobs, run by GameRunThreadedSelfTests
+void TestMemoryTrackingThreaded();
+
+const MemoryHistory* GetMemoryHistory();
+
+// Oldest frame first
+bool MemoryHistoryWriteCsv(const char* path);
+
 void InitializeMemoryTracking();
 void ShutdownMemoryTracking();
 
+// Logs the callsites that allocated the most bytes
+void LogMemoryCallsites(int count);
+
 void Internal_PushMemoryIgnoreFree();
 void Internal_PopMemoryIgnoreFree();
 void Internal_PushMemoryAdditionalInfo(const char* file, const char* func, int line);
@@ -9,8 +9,6 @@
 constexpr int MAX_SEARCH_TILES = 64 * 16;
 constexpr int PATHFINDER_TABLE_SIZE = MAX_SEARCH_TILES + (int)((float)MAX_SEARCH_TILES * HASHSET_LOAD_FACTOR);
 
-#define AllocNode() ((Node*)SAlloc(SAllocatorFrame(), sizeof(Node)));
-
 internal int 
 ManhattanDistance(Vec2i v0, Vec2i v1)
 {
@@ -41,10 +39,34 @@ void
 PathfinderInit(Pathfinder* pathfinder)
 {
 	pathfinder->Open = BHeapCreate(SAllocatorArena(&GetGameState()->GameArena), CompareCost, 2048);
-	HashMapTInitialize(&pathfinder->OpenSet, 2048, SAllocatorArena(&GetGameState()->GameArena));
+	HashMapSwissInitialize(&pathfinder->OpenSet, 2048, SAllocatorArena(&GetGameState()->GameArena));
 	HashSetTInitialize(&pathfinder->ClosedSet, 2048, SAllocatorArena(&GetGameState()->GameArena));
 }
 
+Node*
+PathfinderAllocNode(Pathfinder* pathfinder)
+{
+	Node* node = (Node*)PoolConcurrentAlloc(&GetGameState()->PathNodePool);
+	node->NextAllocated = pathfinder->Nodes;
+	pathfinder->Nodes = node;
+	return node;
+}
+
+void
+PathfinderReleaseNodes(Pathfinder* pathfinder)
+{
+	PoolConcurrentBatch batch = {};
+	Node* node = pathfinder->Nodes;
+	while (node)
+	{
+		Node* next = node->NextAllocated;
+		PoolConcurrentBatchAdd(&batch, node);
+		node = next;
+	}
+	PoolConcurrentFreeBatch(&GetGameState()->PathNodePool, &batch);
+	pathfinder->Nodes = nullptr;
+}
+
 SList<Vec2i>
 PathFindArray(Pathfinder* pathfinder, TileMap_t* tilemap, Vec2i start, Vec2i end)
 {
@@ -96,10 +118,13 @@ Node*
 FindPath(Pathfinder* pathfinder, TileMap_t* tilemap, Vec2i start, Vec2i end)
 {
 	BHeapClear(pathfinder->Open);
-	HashMapTClear(&pathfinder->OpenSet);
+	HashMapSwissClear(&pathfinder->OpenSet);
 	HashSetTClear(&pathfinder->ClosedSet);
+	PathfinderReleaseNodes(pathfinder);
 
-	Node* node = AllocNode();
+	TileCursor cursor = TileCursorCreate(tilemap);
+
+	Node* node = PathfinderAllocNode(pathfinder);
 	node->Pos = start;
 	node->Parent = nullptr;
 	node->GCost = 0;
@@ -108,7 +133,7 @@ FindPath(Pathfinder* pathfinder, TileMap_t* tilemap, Vec2i start, Vec2i end)
 
 	BHeapPushMin(pathfinder->Open, node, node);
 	//u64 firstHash = HashTile(node->Pos);
-	HashMapTSet(&pathfinder->OpenSet, &node->Pos, &node->FCost);
+	HashMapSwissSet(&pathfinder->OpenSet, &node->Pos, &node->FCost);
 
 	while (pathfinder->Open->Count > 0)
 	{
@@ -117,7 +142,7 @@ FindPath(Pathfinder* pathfinder, TileMap_t* tilemap, Vec2i start, Vec2i end)
 		Node* curNode = (Node*)item.User;
 
 		//u64 hash = HashTile(node->Pos);
-		HashMapTRemove(&pathfinder->OpenSet, &node->Pos);
+		HashMapSwissRemove(&pathfinder->OpenSet, &node->Pos);
 		HashSetTSet(&pathfinder->ClosedSet, &node->Pos);
 
 		if (curNode->Pos == end)
@@ -126,6 +151,7 @@ FindPath(Pathfinder* pathfinder, TileMap_t* tilemap, Vec2i start, Vec2i end)
 		}
 		else
 		{
+			u8 solidNeighbors = TileCursorGetSolidNeighbors(&cursor, curNode->Pos);
 			for (size_t i = 0; i < ArrayLength(Vec2i_NEIGHTBORS); ++i)
 			{
 				if (pathfinder->Open->Count >= MAX_SEARCH_TILES)
@@ -134,23 +160,26 @@ FindPath(Pathfinder* pathfinder, TileMap_t* tilemap, Vec2i start, Vec2i end)
 					return nullptr;
 				}
 
+				if (BitGet(solidNeighbors, i))
+					continue;
+
 				Vec2i next = curNode->Pos + Vec2i_NEIGHTBORS[i];
 
 				//u64 nextHash = HashTile(next);
 				if (HashSetTContains(&pathfinder->ClosedSet, &next))
 					continue;
 
-				Tile* tile = GetTile(tilemap, next);
-				if (!tile || tile->Flags.Get(TILE_FLAG_COLLISION))
+				Tile* tile = TileCursorGet(&cursor, next);
+				if (!tile)
 					continue;
 				else
 				{
-					int* nextCost = HashMapTGet(&pathfinder->OpenSet, &next);
+					int* nextCost = HashMapSwissGet(&pathfinder->OpenSet, &next);
 					int tileCost = GetTileDef(tile->BackgroundId)->MovementCost;
 					int cost = curNode->GCost + ManhattanDistance(curNode->Pos, next) + tileCost;
 					if (!nextCost || cost < *nextCost)
 					{
-						Node* nextNode = AllocNode();
+						Node* nextNode = PathfinderAllocNode(pathfinder);
 						nextNode->Pos = next;
 						nextNode->Parent = curNode;
 						nextNode->GCost = cost;
@@ -160,7 +189,7 @@ FindPath(Pathfinder* pathfinder, TileMap_t* tilemap, Vec2i start, Vec2i end)
 						BHeapPushMin(pathfinder->Open, nextNode, nextNode);
 						if (!nextCost)
 						{
-							HashMapTSet(&pathfinder->OpenSet, &next, &nextNode->GCost);
+							HashMapSwissSet(&pathfinder->OpenSet, &next, &nextNode->GCost);
 						}
 						else
 						{
@@ -2,22 +2,28 @@
 
 #include "TileMapFixed.h"
 
+#include "Lib/Pool.h"
+
 #include "Structures/BHeap.h"
 #include "Structures/HashMap.h"
 #include "Structures/HashSet.h"
 #include "Structures/SList.h"
 #include "Structures/HashMapT.h"
+#include "Structures/HashMapSwiss.h"
 #include "Structures/HashSetT.h"
 
 constexpr int MAX_PATHFIND_LENGTH = CHUNK_SIZE * 5;
 
+struct Node;
+
 struct Pathfinder
 {
 	BHeap* Open;
-	HashMapT<Vec2i, int> OpenSet;
+	HashMapSwiss<Vec2i, int> OpenSet;
 	HashSetT<Vec2i> ClosedSet;
 	//HashMap OpenSet;
 	//HashSet ClosedSet;
+	Node* Nodes; // Every node of the last search, they go back to the pool when the next one starts
 };
 
 struct Node
@@ -27,12 +33,17 @@ struct Node
 	int FCost;
 	int HCost;
 	int GCost;
+	Node* NextAllocated;
 };
 
 typedef TileMapFixed TileMap_t;
 
 void PathfinderInit(Pathfinder* pathfinder);
 
+// Nodes come from GameState::PathNodePool, safe to search from jobs with a Pathfinder each
+Node* PathfinderAllocNode(Pathfinder* pathfinder);
+void PathfinderReleaseNodes(Pathfinder* pathfinder);
+
 SList<Vec2i> PathFindArray(Pathfinder* pathfinder, TileMap_t* tilemap, Vec2i start, Vec2i end);
 
 int PathFindArrayFill(Vec2i* inFillArray, Pathfinder* pathfinder, TileMap_t* tilemap, Vec2i start, Vec2i end);
@@ -10,3 +10,19 @@ struct RectI
 	int w;
 	int h;
 };
+
+// Smallest rect containing both, empty rects are ignored
+inline RectI
+RectIUnion(RectI a, RectI b)
+{
+	if (a.w <= 0 || a.h <= 0)
+		return b;
+	if (b.w <= 0 || b.h <= 0)
+		return a;
+
+	int minX = (a.x < b.x) ? a.x : b.x;
+	int minY = (a.y < b.y) ? a.y : b.y;
+	int maxX = (a.x + a.w > b.x + b.w) ? a.x + a.w : b.x + b.w;
+	int maxY = (a.y + a.h > b.y + b.h) ? a.y + a.h : b.y + b.h;
+	return { minX, minY, maxX - minX, maxY - minY };
+}
@@ -8,23 +8,52 @@
 
 constant_var u8 INVERSE_DIRECTIONS[] = { 2, 3, 0, 1 };
 
-internal_var HashMapT<Vec2i, Region> RegionMap;
+internal_var HashMapSwiss<Vec2i, Region> RegionMap;
 
 Region*
 GetRegion(Vec2i tilePos)
 {
-	return HashMapTGet(&RegionMap, &tilePos);
+	return HashMapSwissGet(&RegionMap, &tilePos);
 }
 
 internal _FORCE_INLINE_ Vec2i
 TileCoordToRegionCoord(Vec2i tile)
 {
 	Vec2i res;
-	res.x = (int)floorf((float)tile.x / REGION_SIZE);
-	res.y = (int)floorf((float)tile.y / REGION_SIZE);
+	res.x = tile.x >> REGION_SIZE_SHIFT;
+	res.y = tile.y >> REGION_SIZE_SHIFT;
 	return res;
 }
 
+// Indexed by Vec2i_CARDINALS direction
+constant_var Vec2i REGION_SIDE_STARTS[4] = { { 0, 0 }, { REGION_SIZE - 1, 0 }, { 0, REGION_SIZE - 1 }, { 0, 0 } };
+constant_var Vec2i REGION_SIDE_STEPS[4] = { { 1, 0 }, { 0, 1 }, { 1, 0 }, { 0, 1 } };
+
+// Bit n is set if side tile n or the tile across the side is solid
+internal u32
+RegionSideBlockedMask(TileCursor* cursor, Vec2i sideStart, int side)
+{
+	Vec2i across = sideStart + Vec2i_CARDINALS[side];
+	u32 mask = 0;
+	if (REGION_SIDE_STEPS[side].x)
+	{
+		// Horizontal sides are a slice of 2 collision rows
+		u32 rows = TileCursorGetCollisionRow(cursor, sideStart) | TileCursorGetCollisionRow(cursor, across);
+		mask = rows >> (sideStart.x & CHUNK_SIZE_MASK);
+	}
+	else
+	{
+		for (int i = 0; i < REGION_SIZE; ++i)
+		{
+			Vec2i offset = { 0, i };
+			if (TileCursorIsSolid(cursor, sideStart + offset)
+				|| TileCursorIsSolid(cursor, across + offset))
+				mask |= 1u << i;
+		}
+	}
+	return mask & ((1u << REGION_SIZE) - 1);
+}
+
 internal int
 RegionCompareCost(void* cur, void* parent)
 {
@@ -60,14 +89,38 @@ CalculateDistance(Vec2i v0, Vec2i v1)
 	return res;
 }
 
+internal RegionNode*
+AllocRegionNode(RegionPathfinder* pathfinder)
+{
+	RegionNode* node = (RegionNode*)PoolConcurrentAlloc(&GetGameState()->RegionNodePool);
+	node->NextAllocated = pathfinder->Nodes;
+	pathfinder->Nodes = node;
+	return node;
+}
+
+internal void
+ReleaseRegionNodes(RegionPathfinder* pathfinder)
+{
+	PoolConcurrentBatch batch = {};
+	RegionNode* node = pathfinder->Nodes;
+	while (node)
+	{
+		RegionNode* next = node->NextAllocated;
+		PoolConcurrentBatchAdd(&batch, node);
+		node = next;
+	}
+	PoolConcurrentFreeBatch(&GetGameState()->RegionNodePool, &batch);
+	pathfinder->Nodes = nullptr;
+}
+
 void
 PathfinderRegionsInit(RegionPathfinder* pathfinder)
 {
 	constexpr size_t PATHFINDER_REGION_SIZE = 1024;
 	constexpr size_t REGION_MAP_SIZE = VIEW_DISTANCE_TOTAL_CHUNKS * DIVISIONS * DIVISIONS;
-	HashMapTInitialize(&RegionMap, REGION_MAP_SIZE, SAllocatorArena(&GetGameState()->GameArena));
+	HashMapSwissInitialize(&RegionMap, REGION_MAP_SIZE, SAllocatorArena(&GetGameState()->GameArena));
 	pathfinder->Open = BHeapCreate(SAllocatorArena(&GetGameState()->GameArena), RegionCompareCost, PATHFINDER_REGION_SIZE);
-	HashMapTInitialize(&pathfinder->OpenSet, PATHFINDER_REGION_SIZE, SAllocatorArena(&GetGameState()->GameArena));
+	HashMapSwissInitialize(&pathfinder->OpenSet, PATHFINDER_REGION_SIZE, SAllocatorArena(&GetGameState()->GameArena));
 	HashSetTInitialize(&pathfinder->ClosedSet, PATHFINDER_REGION_SIZE, SAllocatorArena(&GetGameState()->GameArena));
 }
 
@@ -75,10 +128,13 @@ internal void
 Pathfind(Pathfinder* pathfinder, TileMapFixed* tilemap, Vec2i start, Vec2i end, void(*callback)(Node*, void*), void* stack)
 {
 	BHeapClear(pathfinder->Open);
-	HashMapTClear(&pathfinder->OpenSet);
+	HashMapSwissClear(&pathfinder->OpenSet);
 	HashSetTClear(&pathfinder->ClosedSet);
+	PathfinderReleaseNodes(pathfinder);
+
+	TileCursor cursor = TileCursorCreate(tilemap);
 
-	Node* node = ArenaPushStruct(&TransientState.TransientArena, Node);
+	Node* node = PathfinderAllocNode(pathfinder);
 	node->Pos = start;
 	node->Parent = nullptr;
 	node->GCost = 0;
@@ -86,7 +142,7 @@ Pathfind(Pathfinder* pathfinder, TileMapFixed* tilemap, Vec2i start, Vec2i end,
 	node->FCost = node->GCost + node->HCost;
 
 	BHeapPushMin(pathfinder->Open, node, node);
-	HashMapTSet(&pathfinder->OpenSet, &node->Pos, &node->GCost);
+	HashMapSwissSet(&pathfinder->OpenSet, &node->Pos, &node->GCost);
 
 	while (pathfinder->Open->Count > 0)
 	{
@@ -94,7 +150,7 @@ Pathfind(Pathfinder* pathfinder, TileMapFixed* tilemap, Vec2i start, Vec2i end,
 
 		Node* curNode = (Node*)item.User;
 
-		HashMapTRemove(&pathfinder->OpenSet, &curNode->Pos);
+		HashMapSwissRemove(&pathfinder->OpenSet, &curNode->Pos);
 		HashSetTSet(&pathfinder->ClosedSet, &curNode->Pos);
 
 		if (curNode->Pos == end)
@@ -109,24 +165,28 @@ Pathfind(Pathfinder* pathfinder, TileMapFixed* tilemap, Vec2i start, Vec2i end,
 		}
 		else
 		{
+			u8 solidNeighbors = TileCursorGetSolidNeighbors(&cursor, curNode->Pos);
 			for (size_t i = 0; i < ArrayLength(Vec2i_NEIGHTBORS); ++i)
 			{
+				if (BitGet(solidNeighbors, i))
+					continue;
+
 				Vec2i nextTile = curNode->Pos + Vec2i_NEIGHTBORS[i];
 
 				if (HashSetTContains(&pathfinder->ClosedSet, &nextTile))
 					continue;
 
-				Tile* tile = GetTile(tilemap, nextTile);
-				if (!tile || tile->Flags.Get(TILE_FLAG_COLLISION))
+				Tile* tile = TileCursorGet(&cursor, nextTile);
+				if (!tile)
 					continue;
 				else
 				{
-					int* nextCost = HashMapTGet(&pathfinder->OpenSet, &nextTile);
+					int* nextCost = HashMapSwissGet(&pathfinder->OpenSet, &nextTile);
 					int tileCost = GetTileDef(tile->BackgroundId)->MovementCost;
 					int cost = curNode->GCost + CalculateDistance(curNode->Pos, nextTile) + tileCost;
 					if (!nextCost || cost < *nextCost)
 					{
-						Node* nextNode = ArenaPushStruct(&TransientState.TransientArena, Node);
+						Node* nextNode = PathfinderAllocNode(pathfinder);
 						nextNode->Pos = nextTile;
 						nextNode->Parent = curNode;
 						nextNode->GCost = cost;
@@ -136,7 +196,7 @@ Pathfind(Pathfinder* pathfinder, TileMapFixed* tilemap, Vec2i start, Vec2i end,
 						BHeapPushMin(pathfinder->Open, nextNode, nextNode);
 						if (!nextCost)
 						{
-							HashMapTSet(&pathfinder->OpenSet, &nextTile, &nextNode->GCost);
+							HashMapSwissSet(&pathfinder->OpenSet, &nextTile, &nextNode->GCost);
 						}
 						else
 						{
@@ -163,6 +223,8 @@ RegionLoad(TileMapFixed* tilemap, Vec2i chunkCoord)
 		RegionUnload(chunkCoord);
 	}
 
+	TileCursor cursor = TileCursorCreate(tilemap);
+
 	// Creates regions and checks each side if able to move to neighboring region
 	for (int yDiv = 0; yDiv < DIVISIONS; ++yDiv)
 	{
@@ -179,95 +241,24 @@ RegionLoad(TileMapFixed* tilemap, Vec2i chunkCoord)
 				region.Sides[i] = Vec2i_NULL;
 			}
 
-			for (int i = 0; i < (int)ArrayLength(REGION_SIDE_POINTS); ++i)
+			for (int side = 0; side < (int)ArrayLength(REGION_SIDE_STARTS); ++side)
 			{
-				constexpr int SIDE = 0;
-
-				int sideIdx = REGION_SIDE_POINTS[i];
-				Vec2i offset = { sideIdx, 0 };
-				Vec2i tilePos = pos + offset;
-				Vec2i neighborTilePos = tilePos + Vec2i_CARDINALS[SIDE];
-
-				Tile* tile = GetTile(tilemap, tilePos);
-				if (!tile || tile->Flags.Get(TILE_FLAG_COLLISION))
-					continue;
-
-				Tile* neighborTile = GetTile(tilemap, neighborTilePos);
-				if (!neighborTile || neighborTile->Flags.Get(TILE_FLAG_COLLISION))
-					continue;
-
-				region.Sides[SIDE] = tilePos;
-				region.SideConnections[SIDE] = neighborTilePos;
-				break;
-			}
-
-			for (int i = 0; i < (int)ArrayLength(REGION_SIDE_POINTS); ++i)
-			{
-				constexpr int SIDE = 1;
-
-				int sideIdx = REGION_SIDE_POINTS[i];
-				Vec2i offset = { REGION_SIZE - 1, sideIdx };
-				Vec2i tilePos = pos + offset;
-				Vec2i neighborTilePos = tilePos + Vec2i_CARDINALS[SIDE];
-
-				Tile* tile = GetTile(tilemap, tilePos);
-				if (!tile || tile->Flags.Get(TILE_FLAG_COLLISION))
-					continue;
-
-				Tile* neighborTile = GetTile(tilemap, neighborTilePos);
-				if (!neighborTile || neighborTile->Flags.Get(TILE_FLAG_COLLISION))
-					continue;
-
-				region.Sides[SIDE] = tilePos;
-				region.SideConnections[SIDE] = neighborTilePos;
-				break;
-			}
-
-			for (int i = 0; i < (int)ArrayLength(REGION_SIDE_POINTS); ++i)
-			{
-				constexpr int SIDE = 2;
-
-				int sideIdx = REGION_SIDE_POINTS[i];
-				Vec2i offset = { sideIdx, REGION_SIZE - 1 };
-				Vec2i tilePos = pos + offset;
-				Vec2i neighborTilePos = tilePos + Vec2i_CARDINALS[SIDE];
-
-				Tile* tile = GetTile(tilemap, tilePos);
-				if (!tile || tile->Flags.Get(TILE_FLAG_COLLISION))
-					continue;
-
-				Tile* neighborTile = GetTile(tilemap, neighborTilePos);
-				if (!neighborTile || neighborTile->Flags.Get(TILE_FLAG_COLLISION))
-					continue;
-
-				region.Sides[SIDE] = tilePos;
-				region.SideConnections[SIDE] = neighborTilePos;
-				break;
-			}
-
-			for (int i = 0; i < (int)ArrayLength(REGION_SIDE_POINTS); ++i)
-			{
-				constexpr int SIDE = 3;
-
-				int sideIdx = REGION_SIDE_POINTS[i];
-				Vec2i offset = { 0, sideIdx };
-				Vec2i tilePos = pos + offset;
-				Vec2i neighborTilePos = tilePos + Vec2i_CARDINALS[SIDE];
-
-				Tile* tile = GetTile(tilemap, tilePos);
-				if (!tile || tile->Flags.Get(TILE_FLAG_COLLISION))
-					continue;
-
-				Tile* neighborTile = GetTile(tilemap, neighborTilePos);
-				if (!neighborTile || neighborTile->Flags.Get(TILE_FLAG_COLLISION))
-					continue;
+				Vec2i sideStart = pos + REGION_SIDE_STARTS[side];
+				u32 blocked = RegionSideBlockedMask(&cursor, sideStart, side);
+				for (int i = 0; i < (int)ArrayLength(REGION_SIDE_POINTS); ++i)
+				{
+					int sideIdx = REGION_SIDE_POINTS[i];
+					if (BitGet(blocked, sideIdx))
+						continue;
 
-				region.Sides[SIDE] = tilePos;
-				region.SideConnections[SIDE] = neighborTilePos;
-				break;
+					Vec2i tilePos = sideStart + REGION_SIDE_STEPS[side] * Vec2i{ sideIdx, sideIdx };
+					region.Sides[side] = tilePos;
+					region.SideConnections[side] = tilePos + Vec2i_CARDINALS[side];
+					break;
+				}
 			}
 
-			HashMapTReplace(&RegionMap, &region.Coord, &region);
+			HashMapSwissReplace(&RegionMap, &region.Coord, &region);
 		}
 	}
 
@@ -277,7 +268,7 @@ RegionLoad(TileMapFixed* tilemap, Vec2i chunkCoord)
 		for (int xDiv = 0; xDiv < DIVISIONS; ++xDiv)
 		{
 			Vec2i regionCoord = startRegion + Vec2i{ xDiv, yDiv };
-			Region* region = HashMapTGet(&RegionMap, &regionCoord);
+			Region* region = HashMapSwissGet(&RegionMap, &regionCoord);
 			SAssert(region);
 
 			for (int i = 0; i < REGION_DIR_MAX; ++i)
@@ -328,7 +319,7 @@ RegionUnload(Vec2i chunkCoord)
 			Vec2i pos = startRegionCoord + Vec2i{ xDiv, yDiv };
 			Region* region = GetRegion(pos);
 			SAssert(region);
-			bool removed = HashMapTRemove(&RegionMap, &pos);
+			bool removed = HashMapSwissRemove(&RegionMap, &pos);
 			SAssert(removed);
 		}
 	}
@@ -342,8 +333,9 @@ PathfindRegion(Vec2i tileStart, Vec2i tileEnd, RegionMoveData* moveData)
 	TileMapFixed* tilemap = &GetGameState()->MainTileMap;
 
 	BHeapClear(pathfinder->Open);
-	HashMapTClear(&pathfinder->OpenSet);
+	HashMapSwissClear(&pathfinder->OpenSet);
 	HashSetTClear(&pathfinder->ClosedSet);
+	ReleaseRegionNodes(pathfinder);
 
 	moveData->PathProgress = 0;
 	moveData->Path.Clear();
@@ -367,7 +359,7 @@ PathfindRegion(Vec2i tileStart, Vec2i tileEnd, RegionMoveData* moveData)
 		return;
 	}
 
-	RegionNode* node = ArenaPushStruct(&TransientState.TransientArena, RegionNode);
+	RegionNode* node = AllocRegionNode(pathfinder);
 	node->Pos = regionStart;
 	node->Parent = nullptr;
 	node->GCost = 0;
@@ -376,7 +368,7 @@ PathfindRegion(Vec2i tileStart, Vec2i tileEnd, RegionMoveData* moveData)
 	node->SideFrom = UINT8_MAX; // Start node doesn't come from anywhere, this is used if we reach the dest.
 
 	BHeapPushMin(pathfinder->Open, node, node);
-	HashMapTSet(&pathfinder->OpenSet, &node->Pos, &node);
+	HashMapSwissSet(&pathfinder->OpenSet, &node->Pos, &node);
 
 	while (pathfinder->Open->Count > 0)
 	{
@@ -384,9 +376,9 @@ PathfindRegion(Vec2i tileStart, Vec2i tileEnd, RegionMoveData* moveData)
 
 		RegionNode* curNode = (RegionNode*)item.User;
 
-		HashMapTRemove(&pathfinder->OpenSet, &curNode->Pos);
+		HashMapSwissRemove(&pathfinder->OpenSet, &curNode->Pos);
 		HashSetTSet(&pathfinder->ClosedSet, &curNode->Pos);
-		Region* curRegion = HashMapTGet(&RegionMap, &curNode->Pos);
+		Region* curRegion = HashMapSwissGet(&RegionMap, &curNode->Pos);
 
 		// Dest reached
 		if (curNode->Pos == regionEnd)
@@ -483,19 +475,19 @@ PathfindRegion(Vec2i tileStart, Vec2i tileEnd, RegionMoveData* moveData)
 				if (HashSetTContains(&pathfinder->ClosedSet, &regionNextCoord))
 					continue;
 
-				Region* regionNext = HashMapTGet(&RegionMap, &regionNextCoord);
+				Region* regionNext = HashMapSwissGet(&RegionMap, &regionNextCoord);
 				if (!regionNext)
 					continue;
 				else
 				{
-					RegionNode** nextNodePtr = HashMapTGet(&pathfinder->OpenSet, &regionNextCoord);
+					RegionNode** nextNodePtr = HashMapSwissGet(&pathfinder->OpenSet, &regionNextCoord);
 					int dist = ManhattanDistance(curNode->Pos, regionNextCoord);
 					int cost = curNode->GCost + dist + curRegion->PathCost[neighborDirection];
 					if (!nextNodePtr || cost < (*nextNodePtr)->GCost)
 					{
 						SAssert(!nextNodePtr || (nextNodePtr && *nextNodePtr));
 
-						RegionNode* nextNode = ArenaPushStruct(&TransientState.TransientArena, RegionNode);
+						RegionNode* nextNode = AllocRegionNode(pathfinder);
 						nextNode->Pos = regionNextCoord;
 						nextNode->Parent = curNode;
 						nextNode->GCost = cost;
@@ -508,7 +500,7 @@ PathfindRegion(Vec2i tileStart, Vec2i tileEnd, RegionMoveData* moveData)
 						BHeapPushMin(pathfinder->Open, nextNode, nextNode);
 						if (!nextNodePtr)
 						{
-							HashMapTSet(&pathfinder->OpenSet, &regionNextCoord, &nextNode);
+							HashMapSwissSet(&pathfinder->OpenSet, &regionNextCoord, &nextNode);
 						}
 						else
 						{
@@ -544,11 +536,11 @@ DrawRegions()
 #if 0
 	for (u32 i = 0; i < RegionMap.Capacity; ++i)
 	{
-		if (RegionMap.Buckets[i].IsUsed)
+		if (RegionMap.Control[i] != HASHMAPSWISS_EMPTY)
 		{
-			for (int side = 0; side < (int)ArrayLength(RegionMap.Buckets[i].Value.Sides); ++side)
+			for (int side = 0; side < (int)ArrayLength(RegionMap.Values[i].Sides); ++side)
 			{
-				Region* region = &RegionMap.Buckets[i].Value;
+				Region* region = &RegionMap.Values[i];
 				Vec2i pos = region->Sides[side];
 				DrawRectangleLines(region->Coord.x * REGION_SIZE * TILE_SIZE, region->Coord.y * REGION_SIZE * TILE_SIZE, REGION_SIZE * TILE_SIZE, REGION_SIZE * TILE_SIZE, RED);
 				if (pos != Vec2i_NULL)
@@ -556,9 +548,9 @@ DrawRegions()
 
 				//for (int dir = 0; dir < REGION_DIR_MAX; ++dir)
 				//{
-				//	for (int idx = 0; idx < (int)ArrayListCount(RegionMap.Buckets[i].Value.Paths[dir]); ++idx)
+				//	for (int idx = 0; idx < (int)ArrayListCount(RegionMap.Values[i].Paths[dir]); ++idx)
 				//	{
-				//		Vec2i tile = RegionMap.Buckets[i].Value.Paths[dir][idx];
+				//		Vec2i tile = RegionMap.Values[i].Paths[dir][idx];
 				//		DrawRectangle(tile.x * TILE_SIZE, tile.y * TILE_SIZE, TILE_SIZE, TILE_SIZE, BLUE);
 				//	}
 				//}
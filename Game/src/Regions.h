@@ -4,7 +4,7 @@
 
 #include "Structures/StaticArray.h"
 #include "Structures/BHeap.h"
-#include "Structures/HashMapT.h"
+#include "Structures/HashMapSwiss.h"
 #include "Structures/HashSetT.h"
 
 struct TileMapFixed;
@@ -13,6 +13,8 @@ struct CMove;
 
 constant_var int DIVISIONS = 4;
 constant_var int REGION_SIZE = CHUNK_SIZE / DIVISIONS;
+constant_var int REGION_SIZE_SHIFT = 3;
+static_assert(REGION_SIZE == 1 << REGION_SIZE_SHIFT, "REGION_SIZE must be a power of 2");
 
 // Order of tiles we check on side to get one most near middle of a region side
 constant_var u8 REGION_SIDE_POINTS[REGION_SIZE] = { 3, 4, 2, 5, 1, 6, 0, 7 };
@@ -53,13 +55,15 @@ struct RegionNode
 	int HCost;
 	int FCost;
 	u8 SideFrom;
+	RegionNode* NextAllocated;
 };
 
 struct RegionPathfinder
 {
 	BHeap* Open;
-	HashMapT<Vec2i, RegionNode*> OpenSet;
+	HashMapSwiss<Vec2i, RegionNode*> OpenSet;
 	HashSetT<Vec2i> ClosedSet;
+	RegionNode* Nodes; // From GameState::RegionNodePool, released when the next search starts
 };
 
 struct Region
@@ -0,0 +1,169 @@
+#include "Scratch.h"
+
+#include "Memory.h"
+#include "Utils.h"
+
+struct ScratchScopeStats
+{
+	zpl_atomic_ptr Name;
+	zpl_atomic64 Count;
+	zpl_atomic64 PeakBytes;
+};
+
+thread_local internal_var Arena ScratchArenas[SCRATCH_ARENA_COUNT];
+
+internal_var ScratchScopeStats ScratchStats[SCRATCH_STATS_CAPACITY];
+internal_var zpl_atomic64 ScratchStatsOverflow;
+
+internal Arena*
+GetScratchArena(const Arena* conflict)
+{
+	for (int i = 0; i < SCRATCH_ARENA_COUNT; ++i)
+	{
+		Arena* arena = &ScratchArenas[i];
+		if (arena == conflict)
+			continue;
+
+		if (!arena->Memory)
+			ArenaCreateVirtual(arena, SCRATCH_ARENA_RESERVE, true);
+		return arena;
+	}
+
+	SError("No scratch arena left that doesn't conflict");
+	return nullptr;
+}
+
+// Slots are claimed by the first scope with that name, lock free since jobs use scratch too
+internal void
+RecordScratchScope(const char* name, size_t peak)
+{
+	u64 hash = HashMix64((u64)(uintptr_t)name);
+	for (u32 probe = 0; probe < SCRATCH_STATS_CAPACITY; ++probe)
+	{
+		ScratchScopeStats* stats = &ScratchStats[(hash + probe) & (SCRATCH_STATS_CAPACITY - 1)];
+		void* slotName = zpl_atomic_ptr_load(&stats->Name);
+		if (!slotName)
+			slotName = zpl_atomic_ptr_compare_exchange(&stats->Name, nullptr, (void*)name);
+
+		if (slotName && slotName != name)
+			continue;
+
+		zpl_atomic64_fetch_add(&stats->Count, 1);
+		i64 prev = zpl_atomic64_load(&stats->PeakBytes);
+		while ((i64)peak > prev)
+		{
+			i64 cur = zpl_atomic64_compare_exchange(&stats->PeakBytes, prev, (i64)peak);
+			if (cur == prev)
+				break;
+			prev = cur;
+		}
+		return;
+	}
+	zpl_atomic64_fetch_add(&ScratchStatsOverflow, 1);
+}
+
+ScratchScope::ScratchScope(const char* name, const Arena* conflict)
+{
+	ScratchArena = GetScratchArena(conflict);
+	Name = name;
+	Start = ScratchArena->TotalAllocated;
+	OuterHighWater = ScratchArena->HighWater;
+	ArenaResetHighWater(ScratchArena);
+	// TempCount tells ScratchCheckLeaks the arena has an open scope
+	++ScratchArena->TempCount;
+}
+
+ScratchScope::~ScratchScope()
+{
+	SAssertMsg(ScratchArena->TotalAllocated >= Start, "Scratch arena was rewound past an open scope");
+	SAssert(ScratchArena->TempCount > 0);
+
+	size_t peak = ScratchArena->HighWater - Start;
+	if (Name)
+		RecordScratchScope(Name, peak);
+
+#if SCAL_DEBUG
+	// Pointers that escaped the scope read garbage instead of stale but valid looking data
+	memset((u8*)ScratchArena->Memory + Start, 0xCD, peak);
+#endif
+
+	ScratchArena->TotalAllocated = Start;
+	ScratchArena->HighWater = Max(OuterHighWater, ScratchArena->HighWater);
+	--ScratchArena->TempCount;
+
+	if (ScratchArena->TempCount == 0)
+		ArenaDecommit(ScratchArena, ARENA_DECOMMIT_KEEP);
+}
+
+void ScratchCheckLeaks()
+{
+	for (int i = 0; i < SCRATCH_ARENA_COUNT; ++i)
+	{
+		Arena* arena = &ScratchArenas[i];
+		if (arena->TempCount == 0 && arena->TotalAllocated > 0)
+		{
+			SWarn("Scratch arena %d has %zu bytes pushed outside any ScratchScope", i, arena->TotalAllocated);
+			ArenaClear(arena);
+		}
+	}
+}
+
+void LogScratchScopes()
+{
+	SInfoLog("[ Memory ] Scratch scopes, peak is the most one run pushed");
+	for (u32 i = 0; i < SCRATCH_STATS_CAPACITY; ++i)
+	{
+		ScratchScopeStats* stats = &ScratchStats[i];
+		const char* name = (const char*)zpl_atomic_ptr_load(&stats->Name);
+		if (!name)
+			continue;
+
+		SInfoLog("[ Memory ]   %s: %lld runs, %lldkb peak", name,
+				 (long long)zpl_atomic64_load(&stats->Count),
+				 (long long)zpl_atomic64_load(&stats->PeakBytes) / 1024);
+	}
+
+	i64 overflow = zpl_atomic64_load(&ScratchStatsOverflow);
+	if (overflow > 0)
+		SInfoLog("[ Memory ]   %lld runs of scopes that didn't fit in the table", (long long)overflow);
+}
+
+void TestScratchScope()
+{
+	const char* name = "TestScratchScope";
+	u8* outer;
+	{
+		ScratchScope scratch(name);
+		outer = (u8*)SAlloc(scratch.Allocator(), 64);
+		outer[0] = 1;
+
+		// A scope that conflicts with the outer one never gets its arena
+		{
+			ScratchScope inner(nullptr, scratch.ScratchArena);
+			SAssert(inner.ScratchArena != scratch.ScratchArena);
+			u8* tmp = (u8*)SAlloc(inner.Allocator(), 1024);
+			tmp[0] = 2;
+		}
+		SAssert(outer[0] == 1);
+
+		// Nested on the same arena, rewinds to after outer
+		size_t used = scratch.Used();
+		{
+			ScratchScope nested;
+			SAssert(nested.ScratchArena == scratch.ScratchArena);
+			SAlloc(nested.Allocator(), 4096);
+		}
+		SAssert(scratch.Used() == used);
+		SAssert(scratch.ScratchArena->HighWater - scratch.Start >= 4096 + used);
+		SAssert(outer[0] == 1);
+	}
+
+	for (u32 i = 0; i < SCRATCH_STATS_CAPACITY; ++i)
+	{
+		if (zpl_atomic_ptr_load(&ScratchStats[i].Name) == (void*)name)
+			SAssert(zpl_atomic64_load(&ScratchStats[i].PeakBytes) >= 4096);
+	}
+
+	for (int i = 0; i < SCRATCH_ARENA_COUNT; ++i)
+		SAssert(ScratchArenas[i].TotalAllocated == 0 && ScratchArenas[i].TempCount == 0);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Core.h"
+#include "Lib/Arena.h"
+
+// Every thread has SCRATCH_ARENA_COUNT scratch arenas, reserved on first use
+constant_var int SCRATCH_ARENA_COUNT = 2;
+constant_var size_t SCRATCH_ARENA_RESERVE = Megabytes(64);
+constant_var u32 SCRATCH_STATS_CAPACITY = 64;
+
+// Temporary memory, the scratch arena is rewound to where it was when the
+// scope ends. A function that fills memory from one scratch scope while using
+// another for its own work passes the first as conflict, the scope takes a
+// different arena so rewinding can't free the result.
+// Named scopes record how often they run and their peak use, keyed by the
+// name's pointer, see LogScratchScopes.
+struct ScratchScope
+{
+	Arena* ScratchArena;
+	const char* Name;
+	size_t Start;
+	size_t OuterHighWater; // Restored at the end so enclosing scopes keep their peak
+
+	ScratchScope(const char* name = nullptr, const Arena* conflict = nullptr);
+
+	~ScratchScope();
+
+	ScratchScope(const ScratchScope&) = delete;
+	ScratchScope& operator=(const ScratchScope&) = delete;
+
+	_FORCE_INLINE_ SAllocator Allocator() const { return SAllocatorArena(ScratchArena); }
+	_FORCE_INLINE_ size_t Used() const { return ScratchArena->TotalAllocated - Start; }
+};
+
+// Warns about memory left on the calling thread's scratch arenas with no scope
+// open, it would never be rewound. Clears it.
+void ScratchCheckLeaks();
+
+void LogScratchScopes();
+
+void TestScratchScope();
@@ -0,0 +1,226 @@
+#include "SpatialGrid.h"
+
+internal SList<SpatialEntry>*
+InternalGetBucket(SpatialGrid* grid, Vec2i tile)
+{
+	int x = tile.x >> CHUNK_SIZE_SHIFT;
+	int y = tile.y >> CHUNK_SIZE_SHIFT;
+	if (x < 0 || y < 0 || x >= grid->LengthInCells || y >= grid->LengthInCells)
+		return nullptr;
+	return &grid->Buckets[x + y * grid->LengthInCells];
+}
+
+internal u32
+InternalFindEntry(SList<SpatialEntry>* bucket, ecs_entity_t entity)
+{
+	for (u32 i = 0; i < bucket->Count; ++i)
+	{
+		if (bucket->Memory[i].Entity == entity)
+			return i;
+	}
+	return SLIST_NO_FOUND;
+}
+
+void SpatialGridCreate(SpatialGrid* grid, SAllocator allocator, int lengthInCells)
+{
+	SAssert(grid);
+	SAssert(!grid->Buckets);
+	SAssert(lengthInCells > 0);
+
+	int bucketCount = lengthInCells * lengthInCells;
+	grid->Buckets = (SList<SpatialEntry>*)SAlloc(allocator, bucketCount * sizeof(SList<SpatialEntry>));
+	SAssert(grid->Buckets);
+	for (int i = 0; i < bucketCount; ++i)
+	{
+		grid->Buckets[i] = {};
+		grid->Buckets[i].Reserve(allocator, 4);
+	}
+	grid->Allocator = allocator;
+	grid->LengthInCells = lengthInCells;
+	grid->Count = 0;
+}
+
+void SpatialGridDestroy(SpatialGrid* grid)
+{
+	SAssert(grid);
+	SAssert(grid->Buckets);
+
+	int bucketCount = grid->LengthInCells * grid->LengthInCells;
+	for (int i = 0; i < bucketCount; ++i)
+	{
+		grid->Buckets[i].Free();
+	}
+	SFree(grid->Allocator, grid->Buckets);
+	*grid = {};
+}
+
+void SpatialGridAdd(SpatialGrid* grid, ecs_entity_t entity, Vec2i tile)
+{
+	SList<SpatialEntry>* bucket = InternalGetBucket(grid, tile);
+	SAssertMsg(bucket, "Entity added outside of grid");
+	if (!bucket)
+		return;
+
+	SpatialEntry entry;
+	entry.Entity = entity;
+	entry.Tile = tile;
+	bucket->Push(&entry);
+	++grid->Count;
+}
+
+bool SpatialGridRemove(SpatialGrid* grid, ecs_entity_t entity, Vec2i tile)
+{
+	SList<SpatialEntry>* bucket = InternalGetBucket(grid, tile);
+	if (!bucket)
+		return false;
+
+	u32 idx = InternalFindEntry(bucket, entity);
+	if (idx == SLIST_NO_FOUND)
+		return false;
+
+	// Keeps insertion order so FirstAt stays stable
+	bucket->RemoveAt(idx);
+	--grid->Count;
+	return true;
+}
+
+void SpatialGridMove(SpatialGrid* grid, ecs_entity_t entity, Vec2i oldTile, Vec2i newTile)
+{
+	SList<SpatialEntry>* oldBucket = InternalGetBucket(grid, oldTile);
+	SList<SpatialEntry>* newBucket = InternalGetBucket(grid, newTile);
+	if (oldBucket && oldBucket == newBucket)
+	{
+		u32 idx = InternalFindEntry(oldBucket, entity);
+		SAssertMsg(idx != SLIST_NO_FOUND, "Entity not at its old tile");
+		if (idx != SLIST_NO_FOUND)
+		{
+			oldBucket->Memory[idx].Tile = newTile;
+			return;
+		}
+	}
+
+	SpatialGridRemove(grid, entity, oldTile);
+	SpatialGridAdd(grid, entity, newTile);
+}
+
+ecs_entity_t SpatialGridFirstAt(SpatialGrid* grid, Vec2i tile)
+{
+	SList<SpatialEntry>* bucket = InternalGetBucket(grid, tile);
+	if (!bucket)
+		return 0;
+
+	for (u32 i = 0; i < bucket->Count; ++i)
+	{
+		if (bucket->Memory[i].Tile == tile)
+			return bucket->Memory[i].Entity;
+	}
+	return 0;
+}
+
+// Cells overlapping the tile rect, clamped to the grid. min > max if none overlap.
+internal void
+InternalGetCellRange(SpatialGrid* grid, RectI tiles, Vec2i* outMin, Vec2i* outMax)
+{
+	int last = grid->LengthInCells - 1;
+	outMin->x = Max(tiles.x >> CHUNK_SIZE_SHIFT, 0);
+	outMin->y = Max(tiles.y >> CHUNK_SIZE_SHIFT, 0);
+	outMax->x = Min((tiles.x + tiles.w - 1) >> CHUNK_SIZE_SHIFT, last);
+	outMax->y = Min((tiles.y + tiles.h - 1) >> CHUNK_SIZE_SHIFT, last);
+}
+
+SList<SpatialEntry>* SpatialGridGetCell(SpatialGrid* grid, Vec2i chunkCoord)
+{
+	if (chunkCoord.x < 0 || chunkCoord.y < 0 || chunkCoord.x >= grid->LengthInCells || chunkCoord.y >= grid->LengthInCells)
+		return nullptr;
+	return &grid->Buckets[chunkCoord.x + chunkCoord.y * grid->LengthInCells];
+}
+
+_FORCE_INLINE_ internal bool
+InternalIsInRect(Vec2i tile, RectI tiles)
+{
+	// Unsigned compare covers both sides of the rect
+	return (u32)(tile.x - tiles.x) < (u32)tiles.w
+		&& (u32)(tile.y - tiles.y) < (u32)tiles.h;
+}
+
+void SpatialGridQueryRect(SpatialGrid* grid, RectI tiles, SList<ecs_entity_t>* out)
+{
+	SAssert(out);
+	if (tiles.w <= 0 || tiles.h <= 0)
+		return;
+
+	Vec2i min, max;
+	InternalGetCellRange(grid, tiles, &min, &max);
+	for (int y = min.y; y <= max.y; ++y)
+	{
+		for (int x = min.x; x <= max.x; ++x)
+		{
+			SList<SpatialEntry>* bucket = &grid->Buckets[x + y * grid->LengthInCells];
+			for (u32 i = 0; i < bucket->Count; ++i)
+			{
+				if (InternalIsInRect(bucket->Memory[i].Tile, tiles))
+					out->Push(&bucket->Memory[i].Entity);
+			}
+		}
+	}
+}
+
+void SpatialGridQueryRadius(SpatialGrid* grid, Vec2i center, int radius, SList<ecs_entity_t>* out)
+{
+	SAssert(out);
+	SAssert(radius >= 0);
+
+	RectI tiles = { center.x - radius, center.y - radius, radius * 2 + 1, radius * 2 + 1 };
+	int radiusSqr = radius * radius;
+
+	Vec2i min, max;
+	InternalGetCellRange(grid, tiles, &min, &max);
+	for (int y = min.y; y <= max.y; ++y)
+	{
+		for (int x = min.x; x <= max.x; ++x)
+		{
+			SList<SpatialEntry>* bucket = &grid->Buckets[x + y * grid->LengthInCells];
+			for (u32 i = 0; i < bucket->Count; ++i)
+			{
+				int dx = bucket->Memory[i].Tile.x - center.x;
+				int dy = bucket->Memory[i].Tile.y - center.y;
+				if (dx * dx + dy * dy <= radiusSqr)
+					out->Push(&bucket->Memory[i].Entity);
+			}
+		}
+	}
+}
+
+ecs_entity_t SpatialGridFindNearest(SpatialGrid* grid, Vec2i center, int radius, ecs_entity_t ignore)
+{
+	SAssert(radius >= 0);
+
+	RectI tiles = { center.x - radius, center.y - radius, radius * 2 + 1, radius * 2 + 1 };
+	int bestDistSqr = radius * radius + 1;
+	ecs_entity_t best = 0;
+
+	Vec2i min, max;
+	InternalGetCellRange(grid, tiles, &min, &max);
+	for (int y = min.y; y <= max.y; ++y)
+	{
+		for (int x = min.x; x <= max.x; ++x)
+		{
+			SList<SpatialEntry>* bucket = &grid->Buckets[x + y * grid->LengthInCells];
+			for (u32 i = 0; i < bucket->Count; ++i)
+			{
+				if (bucket->Memory[i].Entity == ignore)
+					continue;
+
+				int dx = bucket->Memory[i].Tile.x - center.x;
+				int dy = bucket->Memory[i].Tile.y - center.y;
+				int distSqr = dx * dx + dy * dy;
+				if (distSqr < bestDistSqr)
+				{
+					bestDistSqr = distSqr;
+					best = bucket->Memory[i].Entity;
+				}
+			}
+		}
+	}
+	return best;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Core.h"
+#include "Structures/SList.h"
+
+// Entities bucketed by the chunk their tile is in. Any number of entities
+// can share a tile. Moves inside a chunk only rewrite the entry's tile.
+// Queries append to an output list so callers pick the allocator (usually frame).
+
+struct SpatialEntry
+{
+	ecs_entity_t Entity;
+	Vec2i Tile;
+};
+
+struct SpatialGrid
+{
+	SList<SpatialEntry>* Buckets;
+	SAllocator Allocator;
+	int LengthInCells;
+	u32 Count;
+};
+
+void SpatialGridCreate(SpatialGrid* grid, SAllocator allocator, int lengthInCells);
+void SpatialGridDestroy(SpatialGrid* grid);
+
+void SpatialGridAdd(SpatialGrid* grid, ecs_entity_t entity, Vec2i tile);
+bool SpatialGridRemove(SpatialGrid* grid, ecs_entity_t entity, Vec2i tile);
+void SpatialGridMove(SpatialGrid* grid, ecs_entity_t entity, Vec2i oldTile, Vec2i newTile);
+
+// Every entity in one chunk, cells are chunks. Null outside the grid.
+SList<SpatialEntry>* SpatialGridGetCell(SpatialGrid* grid, Vec2i chunkCoord);
+
+// Returns the first entity added to tile that's still there, 0 if none
+ecs_entity_t SpatialGridFirstAt(SpatialGrid* grid, Vec2i tile);
+// Tile rects are inclusive of x..x+w-1, y..y+h-1
+void SpatialGridQueryRect(SpatialGrid* grid, RectI tiles, SList<ecs_entity_t>* out);
+void SpatialGridQueryRadius(SpatialGrid* grid, Vec2i center, int radius, SList<ecs_entity_t>* out);
+// Closest by tile distance within radius, 0 if none
+ecs_entity_t SpatialGridFindNearest(SpatialGrid* grid, Vec2i center, int radius, ecs_entity_t ignore);
+
+inline void TestSpatialGrid()
+{
+	SpatialGrid grid = {};
+	SpatialGridCreate(&grid, SAllocatorMalloc(), 2);
+
+	SList<ecs_entity_t> results = {};
+	results.Reserve(SAllocatorMalloc(), 8);
+
+	// Two on the same tile
+	SpatialGridAdd(&grid, 1, { 1, 1 });
+	SpatialGridAdd(&grid, 2, { 1, 1 });
+	SpatialGridAdd(&grid, 3, { CHUNK_SIZE + 4, 2 });
+	SAssert(grid.Count == 3);
+	SAssert(SpatialGridFirstAt(&grid, { 1, 1 }) == 1);
+	SAssert(SpatialGridFirstAt(&grid, { 2, 1 }) == 0);
+	SAssert(SpatialGridGetCell(&grid, { 0, 0 })->Count == 2);
+	SAssert(SpatialGridGetCell(&grid, { 2, 0 }) == nullptr);
+
+	SpatialGridQueryRect(&grid, { 0, 0, 2, 2 }, &results);
+	SAssert(results.Count == 2);
+
+	// Move within a chunk, then across chunks
+	SpatialGridMove(&grid, 1, { 1, 1 }, { 2, 1 });
+	SAssert(SpatialGridFirstAt(&grid, { 1, 1 }) == 2);
+	SpatialGridMove(&grid, 2, { 1, 1 }, { CHUNK_SIZE + 3, 2 });
+
+	results.Clear();
+	SpatialGridQueryRadius(&grid, { CHUNK_SIZE + 3, 2 }, 1, &results);
+	SAssert(results.Count == 2);
+
+	SAssert(SpatialGridFindNearest(&grid, { CHUNK_SIZE, 2 }, 8, 0) == 2);
+	SAssert(SpatialGridFindNearest(&grid, { CHUNK_SIZE, 2 }, 8, 2) == 3);
+	SAssert(SpatialGridFindNearest(&grid, { 2, CHUNK_SIZE }, 4, 0) == 0);
+
+	bool removed = SpatialGridRemove(&grid, 3, { CHUNK_SIZE + 4, 2 });
+	bool removedTwice = SpatialGridRemove(&grid, 3, { CHUNK_SIZE + 4, 2 });
+	SAssert(removed && !removedTwice);
+	SAssert(grid.Count == 2);
+
+	results.Free();
+	SpatialGridDestroy(&grid);
+}
@@ -0,0 +1,137 @@
+#include "SpriteBatch.h"
+
+#include <raylib/src/rlgl.h>
+
+#include <stdlib.h>
+
+void
+SpriteBatchInitialize(SpriteBatch* batch, SAllocator allocator, u32 capacity)
+{
+	SAssert(batch);
+	SAssert(capacity > 0);
+	*batch = {};
+	batch->Quads.Reserve(allocator, capacity);
+	batch->TextureIds.Reserve(allocator, capacity);
+	batch->SortKeys.Reserve(allocator, capacity);
+}
+
+void
+SpriteBatchFree(SpriteBatch* batch)
+{
+	SAssert(batch);
+	batch->Quads.Free();
+	batch->TextureIds.Free();
+	batch->SortKeys.Free();
+	*batch = {};
+}
+
+void
+SpriteBatchPush(SpriteBatch* batch, const Texture2D* texture, Rectangle source, Rectangle dest, Vec2 origin, Color tint, bool flipX)
+{
+	SAssert(batch);
+	SAssert(texture);
+	SAssert(texture->width > 0 && texture->height > 0);
+
+	float invWidth = 1.0f / (float)texture->width;
+	float invHeight = 1.0f / (float)texture->height;
+
+	float left = dest.x - origin.x;
+	float top = dest.y - origin.y;
+	float right = left + dest.width;
+	float bottom = top + dest.height;
+
+	float u0 = source.x * invWidth;
+	float v0 = source.y * invHeight;
+	float u1 = (source.x + source.width) * invWidth;
+	float v1 = (source.y + source.height) * invHeight;
+	if (flipX)
+	{
+		float tmp = u0;
+		u0 = u1;
+		u1 = tmp;
+	}
+
+	SpriteQuad* quad = batch->Quads.PushNew();
+	quad->Vertices[0] = { { left, top }, { u0, v0 }, tint };
+	quad->Vertices[1] = { { left, bottom }, { u0, v1 }, tint };
+	quad->Vertices[2] = { { right, bottom }, { u1, v1 }, tint };
+	quad->Vertices[3] = { { right, top }, { u1, v0 }, tint };
+
+	batch->TextureIds.Push(&texture->id);
+}
+
+internal int
+CompareSortKeys(const void* a, const void* b)
+{
+	u64 keyA = *(const u64*)a;
+	u64 keyB = *(const u64*)b;
+	return (keyA < keyB) ? -1 : (keyA > keyB);
+}
+
+void
+SpriteBatchSort(SpriteBatch* batch)
+{
+	SAssert(batch);
+	SAssert(batch->TextureIds.Count == batch->Quads.Count);
+
+	// Quad index in the low bits keeps the sort stable
+	batch->SortKeys.Clear();
+	for (u32 i = 0; i < batch->Quads.Count; ++i)
+	{
+		u64 key = ((u64)*batch->TextureIds.At(i) << 32ull) | (u64)i;
+		batch->SortKeys.Push(&key);
+	}
+
+	if (batch->SortKeys.Count > 1)
+		qsort(batch->SortKeys.Memory, batch->SortKeys.Count, sizeof(u64), CompareSortKeys);
+}
+
+void
+SpriteBatchFlush(SpriteBatch* batch)
+{
+	SAssert(batch);
+
+	batch->DrawCalls = 0;
+	if (batch->Quads.Count == 0)
+		return;
+
+	SpriteBatchSort(batch);
+
+	u32 currentTexture = 0;
+	bool hasBegun = false;
+	for (u32 i = 0; i < batch->SortKeys.Count; ++i)
+	{
+		u64 key = *batch->SortKeys.At(i);
+		u32 textureId = (u32)(key >> 32ull);
+		SpriteQuad* quad = batch->Quads.At((u32)key);
+
+		if (!hasBegun || textureId != currentTexture)
+		{
+			if (hasBegun)
+				rlEnd();
+
+			currentTexture = textureId;
+			hasBegun = true;
+			++batch->DrawCalls;
+
+			rlSetTexture(textureId);
+			rlBegin(RL_QUADS);
+			rlNormal3f(0.0f, 0.0f, 1.0f);
+		}
+
+		// rlgl flushes its own vertex buffer when full and keeps the texture
+		rlCheckRenderBatchLimit(4);
+		for (int v = 0; v < 4; ++v)
+		{
+			const SpriteVertex* vertex = &quad->Vertices[v];
+			rlColor4ub(vertex->Color.r, vertex->Color.g, vertex->Color.b, vertex->Color.a);
+			rlTexCoord2f(vertex->UV.x, vertex->UV.y);
+			rlVertex2f(vertex->Pos.x, vertex->Pos.y);
+		}
+	}
+
+	rlEnd();
+	rlSetTexture(0);
+
+	SpriteBatchClear(batch);
+}
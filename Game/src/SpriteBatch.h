@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Core.h"
+#include "Memory.h"
+
+#include "Structures/SList.h"
+
+// Collects textured quads on the CPU, SpriteBatchFlush sorts them by texture
+// and submits each texture's quads in one go. Quads sharing a texture keep
+// their push order, quads of different textures do not.
+
+struct SpriteVertex
+{
+	Vec2 Pos;
+	Vec2 UV;
+	Color Color;
+};
+
+// Vertices are top left, bottom left, bottom right, top right (RL_QUADS order)
+struct SpriteQuad
+{
+	SpriteVertex Vertices[4];
+};
+
+struct SpriteBatch
+{
+	SList<SpriteQuad> Quads;
+	SList<u32> TextureIds; // Per quad
+	SList<u64> SortKeys; // TextureId << 32 | quad index
+	int DrawCalls; // Texture switches in the last flush
+};
+
+void SpriteBatchInitialize(SpriteBatch* batch, SAllocator allocator, u32 capacity);
+void SpriteBatchFree(SpriteBatch* batch);
+
+// Builds a quad the same way as DrawSprite
+void SpriteBatchPush(SpriteBatch* batch, const Texture2D* texture, Rectangle source, Rectangle dest, Vec2 origin, Color tint, bool flipX);
+
+// Fills SortKeys, called by SpriteBatchFlush
+void SpriteBatchSort(SpriteBatch* batch);
+
+// Submits all quads through rlgl and clears the batch
+void SpriteBatchFlush(SpriteBatch* batch);
+
+_FORCE_INLINE_ void
+SpriteBatchClear(SpriteBatch* batch)
+{
+	batch->Quads.Clear();
+	batch->TextureIds.Clear();
+	batch->SortKeys.Clear();
+}
+
+inline void TestSpriteBatch()
+{
+	SpriteBatch batch = {};
+	SpriteBatchInitialize(&batch, SAllocatorMalloc(), 4);
+
+	Texture2D textureA = {};
+	textureA.id = 2;
+	textureA.width = 64;
+	textureA.height = 32;
+
+	Texture2D textureB = textureA;
+	textureB.id = 1;
+
+	SpriteBatchPush(&batch, &textureA, { 16, 8, 16, 16 }, { 100, 50, 16, 16 }, { 8, 8 }, WHITE, false);
+	SpriteBatchPush(&batch, &textureB, { 0, 0, 32, 32 }, { 0, 0, 32, 32 }, {}, RED, true);
+	SpriteBatchPush(&batch, &textureA, { 0, 0, 16, 16 }, { 0, 0, 16, 16 }, {}, WHITE, false);
+	SAssert(batch.Quads.Count == 3);
+
+	SpriteQuad* quad = batch.Quads.At(0);
+	SAssert(quad->Vertices[0].Pos.x == 92 && quad->Vertices[0].Pos.y == 42);
+	SAssert(quad->Vertices[2].Pos.x == 108 && quad->Vertices[2].Pos.y == 58);
+	SAssert(quad->Vertices[0].UV.x == .25f && quad->Vertices[0].UV.y == .25f);
+	SAssert(quad->Vertices[2].UV.x == .5f && quad->Vertices[2].UV.y == .75f);
+
+	// Flipped, left side samples the right of the source
+	quad = batch.Quads.At(1);
+	SAssert(quad->Vertices[0].UV.x == .5f && quad->Vertices[3].UV.x == 0.0f);
+	SAssert(quad->Vertices[0].Color.r == RED.r && quad->Vertices[0].Color.g == RED.g);
+
+	// Grouped by texture, push order kept within a texture
+	SpriteBatchSort(&batch);
+	SAssert((u32)*batch.SortKeys.At(0) == 1);
+	SAssert((u32)*batch.SortKeys.At(1) == 0);
+	SAssert((u32)*batch.SortKeys.At(2) == 2);
+
+	SpriteBatchFree(&batch);
+}
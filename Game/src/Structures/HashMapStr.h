@@ -242,7 +242,7 @@ HashMapStrSet_Internal(HashMapStr<K>* map, const String key, const K* value)
 
 	if (map->Count >= map->MaxCount)
 	{
-		HashMapStrReserve(map, map->Capacity * HASHMAPSTR_NOT_FOUND);
+		HashMapStrReserve(map, map->Capacity * HASHMAPSTR_RESIZE);
 	}
 
 	SAssert(map->Buckets);
@@ -0,0 +1,411 @@
+#pragma once
+
+#include "Core.h"
+#include "Memory.h"
+#include "Utils.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define HASHMAPSWISS_SSE2 1
+#include <emmintrin.h>
+#else
+#define HASHMAPSWISS_SSE2 0
+#endif
+
+#if _WIN32
+#include <intrin.h>
+#endif
+
+// Open addressing hashmap with a separate control byte per slot. Control bytes
+// hold 7 bits of the hash (or EMPTY) and are compared 16 at a time, so most
+// probes never touch keys. Keys and values are stored in their own arrays.
+//
+// Slots are linearly probed, there are no tombstones. Remove backward shifts
+// the following entries like HashMapT does.
+//
+// Control is Capacity + GROUP_WIDTH bytes, the tail mirrors the first group so
+// a group can be loaded at any slot without wrapping.
+
+constant_var i8 HASHMAPSWISS_EMPTY = (i8)0x80;
+
+template<typename K, typename V>
+struct HashMapSwiss
+{
+	constexpr static uint32_t NOT_FOUND = UINT32_MAX;
+	constexpr static uint32_t GROUP_WIDTH = 16;
+	constexpr static uint32_t DEFAULT_CAPACITY = GROUP_WIDTH;
+	constexpr static uint32_t DEFAULT_RESIZE = 2;
+	constexpr static float DEFAULT_LOADFACTOR = 0.8f;
+
+	i8* Control;
+	K* Keys;
+	V* Values;
+	u32 Capacity;
+	u32 Count;
+	u32 MaxCount;
+	SAllocator Alloc;
+};
+
+// Bit i is set if control byte i of the group equals value
+_FORCE_INLINE_ internal u32
+HashMapSwissMatch(const i8* group, i8 value)
+{
+#if HASHMAPSWISS_SSE2
+	__m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+	return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(value)));
+#else
+	u32 mask = 0;
+	for (u32 i = 0; i < 16; ++i)
+	{
+		if (group[i] == value)
+			mask |= 1u << i;
+	}
+	return mask;
+#endif
+}
+
+_FORCE_INLINE_ internal u32
+HashMapSwissFirstBit(u32 mask)
+{
+	SAssert(mask);
+#if _WIN32
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (u32)index;
+#else
+	return (u32)__builtin_ctz(mask);
+#endif
+}
+
+// Low 7 bits go in control, the rest picks the slot
+_FORCE_INLINE_ internal i8
+HashMapSwissH2(u64 hash)
+{
+	return (i8)(hash & 0x7F);
+}
+
+template<typename K, typename V>
+_FORCE_INLINE_ u32
+HashMapSwissHome(HashMapSwiss<K, V>* map, u64 hash)
+{
+	return (u32)(hash >> 7) & (map->Capacity - 1);
+}
+
+template<typename K, typename V>
+_FORCE_INLINE_ void
+HashMapSwissSetControl(HashMapSwiss<K, V>* map, u32 idx, i8 value)
+{
+	map->Control[idx] = value;
+	if (idx < HashMapSwiss<K, V>::GROUP_WIDTH)
+		map->Control[map->Capacity + idx] = value;
+}
+
+template<typename K, typename V>
+void HashMapSwissReserve(HashMapSwiss<K, V>* map, uint32_t capacity);
+
+template<typename K, typename V>
+void HashMapSwissInitialize(HashMapSwiss<K, V>* map, uint32_t capacity, SAllocator alloc)
+{
+	SAssert(map);
+	SAssert(IsAllocatorValid(alloc));
+
+	map->Alloc = alloc;
+	if (capacity > 0)
+	{
+		capacity = (u32)ceilf((float)capacity / HashMapSwiss<K, V>::DEFAULT_LOADFACTOR);
+		HashMapSwissReserve(map, capacity);
+	}
+}
+
+// Puts the key in the first empty slot from its home, the key must not already be in the map
+template<typename K, typename V>
+uint32_t HashMapSwissInsert_Internal(HashMapSwiss<K, V>* map, const K* key, const V* value, u64 hash)
+{
+	SAssert(map->Count < map->Capacity);
+
+	u32 mask = map->Capacity - 1;
+	u32 pos = HashMapSwissHome(map, hash);
+	while (true)
+	{
+		u32 empties = HashMapSwissMatch(map->Control + pos, HASHMAPSWISS_EMPTY);
+		if (empties)
+		{
+			u32 idx = (pos + HashMapSwissFirstBit(empties)) & mask;
+			HashMapSwissSetControl(map, idx, HashMapSwissH2(hash));
+			map->Keys[idx] = *key;
+			if (value)
+				map->Values[idx] = *value;
+			else
+				map->Values[idx] = {};
+			++map->Count;
+			return idx;
+		}
+		pos = (pos + HashMapSwiss<K, V>::GROUP_WIDTH) & mask;
+	}
+}
+
+template<typename K, typename V>
+void HashMapSwissReserve(HashMapSwiss<K, V>* map, uint32_t capacity)
+{
+	SAssert(map);
+	SAssert(IsAllocatorValid(map->Alloc));
+
+	constexpr u32 groupWidth = HashMapSwiss<K, V>::GROUP_WIDTH;
+
+	if (capacity < groupWidth)
+		capacity = groupWidth;
+
+	if (capacity <= map->Capacity)
+		return;
+
+	if (!IsPowerOf2_32(capacity))
+		capacity = AlignPowTwo32Ceil(capacity);
+
+	// Control, keys and values share one allocation
+	size_t controlSize = capacity + groupWidth;
+	size_t keysSize = sizeof(K) * capacity;
+	size_t valuesSize = sizeof(V) * capacity;
+	static_assert(alignof(K) <= 16 && alignof(V) <= 16, "HashMapSwiss doesn't support over aligned types");
+
+	HashMapSwiss<K, V> tmpMap = {};
+	tmpMap.Alloc = map->Alloc;
+	tmpMap.Capacity = capacity;
+	tmpMap.MaxCount = (uint32_t)((float)capacity * HashMapSwiss<K, V>::DEFAULT_LOADFACTOR);
+	tmpMap.Control = (i8*)SAlloc(map->Alloc, controlSize + keysSize + valuesSize);
+	SAssert(tmpMap.Control);
+	tmpMap.Keys = (K*)(tmpMap.Control + controlSize);
+	tmpMap.Values = (V*)((u8*)tmpMap.Keys + keysSize);
+	memset(tmpMap.Control, HASHMAPSWISS_EMPTY, controlSize);
+
+	SAssert(IsPowerOf2_32(tmpMap.Capacity));
+	SAssert(tmpMap.MaxCount < tmpMap.Capacity);
+
+	if (map->Control)
+	{
+		PushMemoryPointer(map->Control);
+
+		for (uint32_t i = 0; i < map->Capacity; ++i)
+		{
+			if (map->Control[i] != HASHMAPSWISS_EMPTY)
+			{
+				K* key = &map->Keys[i];
+				HashMapSwissInsert_Internal(&tmpMap, key, &map->Values[i], Hash(key));
+			}
+		}
+
+		SAssert(map->Count == tmpMap.Count);
+		SFree(map->Alloc, map->Control);
+
+		PopMemoryPointer();
+	}
+
+	*map = tmpMap;
+}
+
+template<typename K, typename V>
+void HashMapSwissClear(HashMapSwiss<K, V>* map)
+{
+	SAssert(map);
+	if (map->Control)
+		memset(map->Control, HASHMAPSWISS_EMPTY, map->Capacity + HashMapSwiss<K, V>::GROUP_WIDTH);
+	map->Count = 0;
+}
+
+template<typename K, typename V>
+void HashMapSwissDestroy(HashMapSwiss<K, V>* map)
+{
+	SAssert(map);
+	SAssert(map->Control);
+	SAssert(IsAllocatorValid(map->Alloc));
+	SFree(map->Alloc, map->Control);
+	map->Control = nullptr;
+	map->Keys = nullptr;
+	map->Values = nullptr;
+	map->Capacity = 0;
+	map->Count = 0;
+}
+
+template<typename K, typename V>
+uint32_t HashMapSwissFind_Internal(HashMapSwiss<K, V>* map, const K* key, u64 hash)
+{
+	u32 mask = map->Capacity - 1;
+	u32 pos = HashMapSwissHome(map, hash);
+	i8 h2 = HashMapSwissH2(hash);
+	while (true)
+	{
+		const i8* group = map->Control + pos;
+		u32 matches = HashMapSwissMatch(group, h2);
+		u32 empties = HashMapSwissMatch(group, HASHMAPSWISS_EMPTY);
+
+		// Nothing past the first empty slot can belong to this probe
+		if (empties)
+			matches &= (empties & (0 - empties)) - 1;
+
+		while (matches)
+		{
+			u32 idx = (pos + HashMapSwissFirstBit(matches)) & mask;
+			if (map->Keys[idx] == *key)
+				return idx;
+			matches &= matches - 1;
+		}
+
+		if (empties)
+			return HashMapSwiss<K, V>::NOT_FOUND;
+
+		pos = (pos + HashMapSwiss<K, V>::GROUP_WIDTH) & mask;
+	}
+}
+
+template<typename K, typename V>
+uint32_t HashMapSwissFind(HashMapSwiss<K, V>* map, K* key)
+{
+	SAssert(map);
+	SAssert(key);
+	SAssert(*key == *key);
+
+	if (!map->Control || map->Count == 0)
+		return HashMapSwiss<K, V>::NOT_FOUND;
+
+	return HashMapSwissFind_Internal(map, key, Hash(key));
+}
+
+template<typename K, typename V>
+V* HashMapSwissGet(HashMapSwiss<K, V>* map, K* key)
+{
+	uint32_t idx = HashMapSwissFind<K, V>(map, key);
+	return (idx != HashMapSwiss<K, V>::NOT_FOUND) ? &map->Values[idx] : nullptr;
+}
+
+// Returns the index of the key, existing values are not overwritten
+template<typename K, typename V>
+uint32_t HashMapSwissSet(HashMapSwiss<K, V>* map, K* key, V* value)
+{
+	SAssert(map);
+	SAssert(key);
+	SAssert(IsAllocatorValid(map->Alloc));
+	SAssert(*key == *key);
+
+	u64 hash = Hash(key);
+	if (map->Control)
+	{
+		uint32_t foundIdx = HashMapSwissFind_Internal(map, key, hash);
+		if (foundIdx != HashMapSwiss<K, V>::NOT_FOUND)
+			return foundIdx;
+	}
+
+	if (map->Count >= map->MaxCount)
+	{
+		HashMapSwissReserve(map, map->Capacity * HashMapSwiss<K, V>::DEFAULT_RESIZE);
+	}
+
+	SAssert(map->Control);
+
+	return HashMapSwissInsert_Internal(map, key, value, hash);
+}
+
+template<typename K, typename V>
+uint32_t HashMapSwissReplace(HashMapSwiss<K, V>* map, K* key, V* value)
+{
+	uint32_t insertedIdx = HashMapSwissSet<K, V>(map, key, nullptr);
+	SAssert(insertedIdx != UINT32_MAX);
+	map->Values[insertedIdx] = *value;
+	return insertedIdx;
+}
+
+template<typename K, typename V>
+bool HashMapSwissRemove(HashMapSwiss<K, V>* map, const K* key)
+{
+	SAssert(map);
+	SAssert(key);
+	SAssert(*key == *key);
+
+	if (!map->Control || map->Count == 0)
+		return false;
+
+	uint32_t hole = HashMapSwissFind_Internal(map, key, Hash(key));
+	if (hole == HashMapSwiss<K, V>::NOT_FOUND)
+		return false;
+
+	// Moves entries after the hole back if the hole is still between them and their home slot
+	u32 mask = map->Capacity - 1;
+	u32 idx = (hole + 1) & mask;
+	while (map->Control[idx] != HASHMAPSWISS_EMPTY)
+	{
+		K* movedKey = &map->Keys[idx];
+		u32 home = HashMapSwissHome(map, Hash(movedKey));
+		if (((idx - home) & mask) >= ((idx - hole) & mask))
+		{
+			HashMapSwissSetControl(map, hole, map->Control[idx]);
+			map->Keys[hole] = map->Keys[idx];
+			map->Values[hole] = map->Values[idx];
+			hole = idx;
+		}
+		idx = (idx + 1) & mask;
+	}
+
+	HashMapSwissSetControl(map, hole, HASHMAPSWISS_EMPTY);
+	--map->Count;
+	return true;
+}
+
+template<typename K, typename V>
+void HashMapSwissForEach(HashMapSwiss<K, V>* map, void(*Fn)(K*, V*, void*), void* stackMemory)
+{
+	SAssert(Fn);
+	u32 processedCount = 0;
+	for (u32 i = 0; i < map->Capacity && processedCount < map->Count; ++i)
+	{
+		if (map->Control[i] != HASHMAPSWISS_EMPTY)
+		{
+			Fn(&map->Keys[i], &map->Values[i], stackMemory);
+			++processedCount;
+		}
+	}
+}
+
+inline void TestHashMapSwiss()
+{
+	HashMapSwiss<u64, u64> map = {};
+	HashMapSwissInitialize(&map, 0, SAllocatorMalloc());
+
+	// Enough to grow a few times and wrap probes around the end
+	constexpr u64 count = 1000;
+	for (u64 i = 0; i < count; ++i)
+	{
+		u64 key = i * 7;
+		u64 value = i;
+		HashMapSwissSet(&map, &key, &value);
+	}
+	SAssert(map.Count == count);
+
+	for (u64 i = 0; i < count; ++i)
+	{
+		u64 key = i * 7;
+		u64* value = HashMapSwissGet(&map, &key);
+		SAssert(value && *value == i);
+
+		u64 missingKey = i * 7 + 1;
+		SAssert(!HashMapSwissGet(&map, &missingKey));
+	}
+
+	for (u64 i = 0; i < count; i += 2)
+	{
+		u64 key = i * 7;
+		bool removed = HashMapSwissRemove(&map, &key);
+		bool removedTwice = HashMapSwissRemove(&map, &key);
+		SAssert(removed && !removedTwice);
+	}
+	SAssert(map.Count == count / 2);
+
+	for (u64 i = 0; i < count; ++i)
+	{
+		u64 key = i * 7;
+		u64* value = HashMapSwissGet(&map, &key);
+		bool removed = (i % 2 == 0);
+		SAssert(removed ? !value : (value && *value == i));
+	}
+
+	HashMapSwissClear(&map);
+	SAssert(map.Count == 0);
+
+	HashMapSwissDestroy(&map);
+}
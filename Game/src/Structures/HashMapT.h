@@ -4,13 +4,15 @@
 #include "Memory.h"
 #include "Utils.h"
 
+// Buckets are used if their Generation matches the map's. Clear bumps the
+// map's Generation instead of touching every bucket, 0 is never a live generation.
 template<typename K, typename V>
 struct HashMapTBucket
 {
 	V Value;
 	K Key;
 	u16 ProbeLength;
-	bool IsUsed;
+	u16 Generation;
 };
 
 template<typename K, typename V>
@@ -25,9 +27,23 @@ struct HashMapT
 	u32 Capacity;
 	u32 Count;
 	u32 MaxCount;
+	u16 Generation;
 	SAllocator Alloc;
 };
 
+template<typename K, typename V>
+_FORCE_INLINE_ bool
+HashMapTIsUsed(const HashMapT<K, V>* map, u32 idx)
+{
+	return map->Buckets[idx].Generation == map->Generation;
+}
+
+template<typename K, typename V>
+uint32_t HashMapTSet(HashMapT<K, V>* map, K* key, V* value);
+
+template<typename K, typename V>
+void HashMapTReserve(HashMapT<K, V>* map, uint32_t capacity);
+
 template<typename K, typename V>
 void HashMapTInitialize(HashMapT<K, V>* map, uint32_t capacity, SAllocator alloc)
 {
@@ -67,7 +83,7 @@ void HashMapTReserve(HashMapT<K, V>* map, uint32_t capacity)
 
 		for (uint32_t i = 0; i < map->Capacity; ++i)
 		{
-			if (map->Buckets[i].IsUsed)
+			if (HashMapTIsUsed(map, i))
 			{
 				HashMapTSet<K, V>(&tmpMap, &map->Buckets[i].Key, &map->Buckets[i].Value);
 			}
@@ -85,6 +101,7 @@ void HashMapTReserve(HashMapT<K, V>* map, uint32_t capacity)
 	{
 		map->Capacity = capacity;
 		map->MaxCount = (uint32_t)((float)map->Capacity * HashMapT<K, V>::DEFAULT_LOADFACTOR);
+		map->Generation = 1;
 
 		SAssert(IsPowerOf2_32(map->Capacity));
 		SAssert(map->MaxCount < map->Capacity);
@@ -97,16 +114,22 @@ void HashMapTReserve(HashMapT<K, V>* map, uint32_t capacity)
 	}
 }
 
+// O(1), buckets from older generations read as unused
 template<typename K, typename V>
 void HashMapTClear(HashMapT<K, V>* map)
 {
 	SAssert(map);
-	for (uint32_t i = 0; i < map->Capacity; ++i)
+	map->Count = 0;
+	if (!map->Buckets)
+		return;
+
+	++map->Generation;
+	if (map->Generation == 0)
 	{
-		map->Buckets[i].ProbeLength = 0;
-		map->Buckets[i].IsUsed = 0;
+		// Wrapped, buckets last used 65535 clears ago would look used again
+		memset(map->Buckets, 0, sizeof(HashMapTBucket<K, V>) * map->Capacity);
+		map->Generation = 1;
 	}
-	map->Count = 0;
 }
 
 template<typename K, typename V>
@@ -137,7 +160,7 @@ uint32_t HashMapTSet(HashMapT<K, V>* map, K* key, V* value)
 	HashMapTBucket<K, V> swapBucket;
 	swapBucket.Key = *key;
 	swapBucket.ProbeLength = 0;
-	swapBucket.IsUsed = true;
+	swapBucket.Generation = map->Generation;
 	if (value)
 		swapBucket.Value = *value;
 	else
@@ -149,7 +172,7 @@ uint32_t HashMapTSet(HashMapT<K, V>* map, K* key, V* value)
 	while (true)
 	{
 		HashMapTBucket<K, V>* bucket = &map->Buckets[idx];
-		if (!bucket->IsUsed) // Bucket is not used
+		if (bucket->Generation != map->Generation) // Bucket is not used
 		{
 			if (insertedIndex == HashMapT<K, V>::NOT_FOUND)
 				insertedIndex = idx;
@@ -219,7 +242,7 @@ uint32_t HashMapTFind(HashMapT<K, V>* map, K* key)
 	while (true)
 	{
 		HashMapTBucket<K, V>* bucket = &map->Buckets[idx];
-		if (!bucket->IsUsed || probeLength > bucket->ProbeLength)
+		if (bucket->Generation != map->Generation || probeLength > bucket->ProbeLength)
 			return HashMapT<K, V>::NOT_FOUND;
 		else if (*key == bucket->Key)
 			return idx;
@@ -254,13 +277,14 @@ bool HashMapTRemove(HashMapT<K, V>* map, const K* key)
 
 	SAssert(map->Buckets);
 
+	uint32_t probeLength = 0;
 	uint32_t index = (uint32_t)HashAndMod(key, map->Capacity);
 	while (true)
 	{
 		HashMapTBucket<K, V>* bucket = &map->Buckets[index];
-		if (!bucket->IsUsed)
+		if (bucket->Generation != map->Generation || probeLength > bucket->ProbeLength)
 		{
-			return false; // No key found
+			return false; // No key found, same early out as Find
 		}
 		else
 		{
@@ -273,10 +297,10 @@ bool HashMapTRemove(HashMapT<K, V>* map, const K* key)
 						index = 0;
 
 					HashMapTBucket<K, V>* nextBucket = &map->Buckets[index];
-					if (!nextBucket->IsUsed || nextBucket->ProbeLength == 0) // No more entires to move
+					if (nextBucket->Generation != map->Generation || nextBucket->ProbeLength == 0) // No more entires to move
 					{
 						map->Buckets[lastIndex].ProbeLength = 0;
-						map->Buckets[lastIndex].IsUsed = false;
+						map->Buckets[lastIndex].Generation = 0;
 						--map->Count;
 						return true;
 					}
@@ -289,6 +313,7 @@ bool HashMapTRemove(HashMapT<K, V>* map, const K* key)
 			}
 			else
 			{
+				++probeLength;
 				++index;
 				if (index == map->Capacity)
 					index = 0; // continue searching till 0 or found equals key
@@ -306,7 +331,7 @@ void HashMapTForEach(HashMapT<K, V>* map, void(*Fn)(K*, V*, void*), void* stackM
 	u32 processedCount = 0;
 	for (u32 i = 0; i < map->Capacity; ++i)
 	{
-		if (map->Buckets[i].IsUsed)
+		if (HashMapTIsUsed(map, i))
 		{
 			Fn(&map->Buckets[i].Key, &map->Buckets[i].Value, stackMemory);
 			if (++processedCount == map->Count)
@@ -323,7 +348,7 @@ void HashMapTPrint(HashMapT<K, V>* map, const char*(*FmtKey)(K*), const char*(*F
 	SAssert(FmtValue);
 	for (u32 i = 0; i < map->Capacity; ++i)
 	{
-		if (map->Buckets[i].IsUsed)
+		if (HashMapTIsUsed(map, i))
 		{
 			SDebugLog("\t[%d] %s (probe: %d) = %s",
 				i,
@@ -337,3 +362,77 @@ void HashMapTPrint(HashMapT<K, V>* map, const char*(*FmtKey)(K*), const char*(*F
 		}
 	}
 }
+
+// Checks every used bucket's ProbeLength is its distance from its home bucket
+template<typename K, typename V>
+bool HashMapTValidate(HashMapT<K, V>* map)
+{
+	u32 count = 0;
+	for (u32 i = 0; i < map->Capacity; ++i)
+	{
+		if (!HashMapTIsUsed(map, i))
+			continue;
+
+		K* key = &map->Buckets[i].Key;
+		u32 home = (u32)HashAndMod(key, map->Capacity);
+		if (((i - home) & (map->Capacity - 1)) != map->Buckets[i].ProbeLength)
+			return false;
+		++count;
+	}
+	return count == map->Count;
+}
+
+inline void TestHashMapT()
+{
+	HashMapT<u64, u64> map = {};
+	HashMapTInitialize(&map, 64, SAllocatorMalloc());
+
+	for (u64 i = 0; i < 48; ++i)
+	{
+		u64 key = i * 13;
+		HashMapTSet(&map, &key, &i);
+	}
+	SAssert(HashMapTValidate(&map));
+
+	for (u64 i = 0; i < 48; i += 3)
+	{
+		u64 key = i * 13;
+		bool removed = HashMapTRemove(&map, &key);
+		bool removedTwice = HashMapTRemove(&map, &key);
+		SAssert(removed && !removedTwice);
+		SAssert(HashMapTValidate(&map));
+	}
+	SAssert(map.Count == 32);
+
+	for (u64 i = 0; i < 48; ++i)
+	{
+		u64 key = i * 13;
+		u64* value = HashMapTGet(&map, &key);
+		SAssert((i % 3 == 0) ? !value : (value && *value == i));
+	}
+
+	// Clear only bumps the generation, old buckets must read as empty
+	u16 generation = map.Generation;
+	HashMapTClear(&map);
+	SAssert(map.Generation == generation + 1);
+	SAssert(map.Count == 0);
+	for (u64 i = 0; i < 48; ++i)
+	{
+		u64 key = i * 13;
+		SAssert(!HashMapTGet(&map, &key));
+	}
+
+	u64 key = 7;
+	u64 value = 70;
+	HashMapTSet(&map, &key, &value);
+	SAssert(*HashMapTGet(&map, &key) == 70);
+	SAssert(HashMapTValidate(&map));
+
+	// Wrapping the generation falls back to zeroing the buckets
+	map.Generation = UINT16_MAX;
+	HashMapTClear(&map);
+	SAssert(map.Generation == 1);
+	SAssert(!HashMapTGet(&map, &key));
+
+	HashMapTDestroy(&map);
+}
@@ -4,12 +4,13 @@
 #include "Memory.h"
 #include "Utils.h"
 
+// Used if Generation matches the set's, see HashMapTBucket
 template<typename K>
 struct HashSetTBucket
 {
 	K Key;
-	uint32_t ProbeLength : 31;
-	uint32_t IsUsed : 1;
+	uint16_t ProbeLength;
+	uint16_t Generation;
 };
 
 template<typename K>
@@ -24,8 +25,16 @@ struct HashSetT
 	uint32_t Capacity;
 	uint32_t Count;
 	uint32_t MaxCount;
+	uint16_t Generation;
 };
 
+template<typename K>
+_FORCE_INLINE_ bool
+HashSetTIsUsed(const HashSetT<K>* set, uint32_t idx)
+{
+	return set->Keys[idx].Generation == set->Generation;
+}
+
 template<typename K>
 void
 HashSetTInitialize(HashSetT<K>* set, uint32_t capacity, SAllocator SAllocator)
@@ -55,7 +64,7 @@ HashSetTReserve(HashSetT<K>* set, uint32_t capacity)
 		return;
 
 	if (!IsPowerOf2_32(capacity))
-		capacity = AlignPowTwo32(capacity);
+		capacity = AlignPowTwo32Ceil(capacity);
 
 	if (set->Keys)
 	{
@@ -65,7 +74,7 @@ HashSetTReserve(HashSetT<K>* set, uint32_t capacity)
 
 		for (uint32_t i = 0; i < set->Capacity; ++i)
 		{
-			if (set->Keys[i].IsUsed)
+			if (HashSetTIsUsed(set, i))
 			{
 				HashSetTSet(&tmpSet, &set->Keys[i].Key);
 			}
@@ -82,6 +91,7 @@ HashSetTReserve(HashSetT<K>* set, uint32_t capacity)
 	{
 		set->Capacity = capacity;
 		set->MaxCount = (uint32_t)((float)set->Capacity * HashSetT<K>::DEFAULT_LOADFACTOR);
+		set->Generation = 1;
 
 		SAssert(IsPowerOf2_32(set->Capacity));
 		SAssert(set->MaxCount < set->Capacity);
@@ -99,9 +109,16 @@ void
 HashSetTClear(HashSetT<K>* set)
 {
 	SAssert(set);
-	size_t size = sizeof(HashSetTBucket<K>) * set->Capacity;
-	memset(set->Keys, 0, size);
 	set->Count = 0;
+	if (!set->Keys)
+		return;
+
+	++set->Generation;
+	if (set->Generation == 0)
+	{
+		memset(set->Keys, 0, sizeof(HashSetTBucket<K>) * set->Capacity);
+		set->Generation = 1;
+	}
 }
 
 template<typename K>
@@ -135,11 +152,11 @@ HashSetTSet(HashSetT<K>* set, const K* key)
 	while (true)
 	{
 		HashSetTBucket<K>* bucket = &set->Keys[idx];
-		if (!bucket->IsUsed) // Bucket is not used
+		if (bucket->Generation != set->Generation) // Bucket is not used
 		{
 			bucket->Key = swapKey;
-			bucket->ProbeLength = probeLength;
-			bucket->IsUsed = 1;
+			bucket->ProbeLength = (uint16_t)probeLength;
+			bucket->Generation = set->Generation;
 			++set->Count;
 			return true;
 		}
@@ -150,7 +167,9 @@ HashSetTSet(HashSetT<K>* set, const K* key)
 
 			if (probeLength > bucket->ProbeLength)
 			{
-				Swap(bucket->ProbeLength, probeLength, uint32_t);
+				uint32_t tmpProbeLength = bucket->ProbeLength;
+				bucket->ProbeLength = (uint16_t)probeLength;
+				probeLength = tmpProbeLength;
 				Swap(bucket->Key, swapKey, K);
 			}
 
@@ -178,7 +197,7 @@ HashSetTContains(HashSetT<K>* set, K* key)
 	while (true)
 	{
 		HashSetTBucket<K>* bucket = &set->Keys[idx];
-		if (!bucket->IsUsed || probeLength > bucket->ProbeLength)
+		if (bucket->Generation != set->Generation || probeLength > bucket->ProbeLength)
 			return false;
 		else if (*key == bucket->Key)
 			return true;
@@ -204,11 +223,12 @@ HashSetTRemove(HashSetT<K>* set, K* key)
 	if (!set->Keys || set->Count == 0)
 		return false;
 
-	uint32_t idx = HashKey(key, sizeof(K), set->Capacity);
+	uint32_t probeLength = 0;
+	uint32_t idx = (uint32_t)HashAndMod(key, set->Capacity);
 	while (true)
 	{
 		HashSetTBucket<K>* bucket = &set->Keys[idx];
-		if (!bucket->IsUsed)
+		if (bucket->Generation != set->Generation || probeLength > bucket->ProbeLength)
 		{
 			return false;
 		}
@@ -224,10 +244,10 @@ HashSetTRemove(HashSetT<K>* set, K* key)
 						idx = 0;
 
 					HashSetTBucket<K>* nextBucket = &set->Keys[idx];
-					if (!nextBucket->IsUsed || nextBucket->ProbeLength == 0) // No more entires to move
+					if (nextBucket->Generation != set->Generation || nextBucket->ProbeLength == 0) // No more entires to move
 					{
 						set->Keys[lastIdx].ProbeLength = 0;
-						set->Keys[lastIdx].IsUsed = 0;
+						set->Keys[lastIdx].Generation = 0;
 						--set->Count;
 						return true;
 					}
@@ -240,6 +260,7 @@ HashSetTRemove(HashSetT<K>* set, K* key)
 			}
 			else
 			{
+				++probeLength;
 				++idx;
 				if (idx == set->Capacity)
 					idx = 0; // continue searching till 0 or found equals key
@@ -249,3 +270,39 @@ HashSetTRemove(HashSetT<K>* set, K* key)
 	SAssertMsg(false, "Shouldn't be executed");
 	return false;
 }
+
+inline void TestHashSetT()
+{
+	HashSetT<u64> set = {};
+	HashSetTInitialize(&set, 64, SAllocatorMalloc());
+
+	for (u64 i = 0; i < 48; ++i)
+	{
+		u64 key = i * 13;
+		SAssert(HashSetTSet(&set, &key));
+	}
+
+	for (u64 i = 0; i < 48; i += 3)
+	{
+		u64 key = i * 13;
+		bool removed = HashSetTRemove(&set, &key);
+		bool removedTwice = HashSetTRemove(&set, &key);
+		SAssert(removed && !removedTwice);
+	}
+	SAssert(set.Count == 32);
+
+	for (u64 i = 0; i < 48; ++i)
+	{
+		u64 key = i * 13;
+		SAssert(HashSetTContains(&set, &key) == (i % 3 != 0));
+	}
+
+	HashSetTClear(&set);
+	for (u64 i = 0; i < 48; ++i)
+	{
+		u64 key = i * 13;
+		SAssert(!HashSetTContains(&set, &key));
+	}
+
+	HashSetTDestroy(&set);
+}
@@ -294,7 +294,7 @@ bool SList<T>::RemoveAtFast(uint32_t index)
 
 	if (index != LastIndex())
 	{
-		SMemCopy(Memory + index, Memory + LastIndex(), sizeof(T));
+		SCopy(Memory + index, Memory + LastIndex(), sizeof(T));
 		wasLastSwapped = true;
 	}
 
@@ -0,0 +1,245 @@
+#pragma once
+
+#include "Core.h"
+#include "Memory.h"
+
+constant_var u32 SEGMENTED_LIST_MAX_SEGMENTS = 32;
+
+// List that never moves its elements, pointers stay valid until the element
+// is removed or the list is cleared. Segment k holds (1 << FirstSizeLog2) << k
+// elements, so a push that fills the list allocates the next segment instead
+// of copying, and an index finds its segment with a bit scan. Segments are
+// kept by Clear and reused. Indices are u32, so it holds at most UINT32_MAX
+// elements, segment sizes are u64 because later segments can pass that.
+template<typename T, u32 FirstSizeLog2 = 4>
+struct SegmentedList
+{
+	static_assert(FirstSizeLog2 < 32, "SegmentedList first segment too large");
+	constexpr static u32 FIRST_SIZE = 1u << FirstSizeLog2;
+
+	SAllocator Alloc;
+	T* Segments[SEGMENTED_LIST_MAX_SEGMENTS];
+	u32 SegmentCount;
+	u32 Count;
+};
+
+_FORCE_INLINE_ internal u32
+SegmentedListHighBit(u64 value)
+{
+	SAssert(value);
+#if _WIN32
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return (u32)index;
+#else
+	return 63 - (u32)__builtin_clzll(value);
+#endif
+}
+
+template<typename T, u32 FirstSizeLog2>
+_FORCE_INLINE_ u64
+SegmentedListSegmentSize(const SegmentedList<T, FirstSizeLog2>* list, u32 segment)
+{
+	return (u64)SegmentedList<T, FirstSizeLog2>::FIRST_SIZE << segment;
+}
+
+template<typename T, u32 FirstSizeLog2>
+_FORCE_INLINE_ u64
+SegmentedListCapacity(const SegmentedList<T, FirstSizeLog2>* list)
+{
+	return ((u64)SegmentedList<T, FirstSizeLog2>::FIRST_SIZE << list->SegmentCount) - SegmentedList<T, FirstSizeLog2>::FIRST_SIZE;
+}
+
+template<typename T, u32 FirstSizeLog2>
+void
+SegmentedListInitialize(SegmentedList<T, FirstSizeLog2>* list, SAllocator allocator)
+{
+	SAssert(list);
+	SAssert(IsAllocatorValid(allocator));
+
+	*list = {};
+	list->Alloc = allocator;
+}
+
+template<typename T, u32 FirstSizeLog2>
+void
+SegmentedListDestroy(SegmentedList<T, FirstSizeLog2>* list)
+{
+	SAssert(list);
+	SAssert(IsAllocatorValid(list->Alloc));
+
+	for (u32 i = 0; i < list->SegmentCount; ++i)
+	{
+		SFree(list->Alloc, list->Segments[i]);
+		list->Segments[i] = nullptr;
+	}
+	list->SegmentCount = 0;
+	list->Count = 0;
+}
+
+template<typename T, u32 FirstSizeLog2>
+_FORCE_INLINE_ T*
+SegmentedListAt(SegmentedList<T, FirstSizeLog2>* list, u32 idx)
+{
+	SAssert(list);
+	SAssert(idx < list->Count);
+
+	// Offsetting by the first segment's size puts segment k's indices in [2^(k + log2), 2^(k + log2 + 1))
+	u64 biased = (u64)idx + SegmentedList<T, FirstSizeLog2>::FIRST_SIZE;
+	u32 highBit = SegmentedListHighBit(biased);
+	u32 segment = highBit - FirstSizeLog2;
+	u64 offset = biased - (1ull << highBit);
+	return list->Segments[segment] + offset;
+}
+
+// Returns where the new element is, uninitialized
+template<typename T, u32 FirstSizeLog2>
+T*
+SegmentedListPushNew(SegmentedList<T, FirstSizeLog2>* list)
+{
+	SAssert(list);
+
+	if (list->Count == UINT32_MAX)
+	{
+		SError("SegmentedList is full");
+		return nullptr;
+	}
+
+	if (list->Count == SegmentedListCapacity(list))
+	{
+		SAssert(IsAllocatorValid(list->Alloc));
+		if (list->SegmentCount == SEGMENTED_LIST_MAX_SEGMENTS)
+		{
+			SError("SegmentedList is full");
+			return nullptr;
+		}
+
+		size_t size = (size_t)SegmentedListSegmentSize(list, list->SegmentCount) * sizeof(T);
+		list->Segments[list->SegmentCount] = (T*)SAlloc(list->Alloc, size);
+		SAssert(list->Segments[list->SegmentCount]);
+		++list->SegmentCount;
+	}
+
+	++list->Count;
+	return SegmentedListAt(list, list->Count - 1);
+}
+
+template<typename T, u32 FirstSizeLog2>
+_FORCE_INLINE_ T*
+SegmentedListPush(SegmentedList<T, FirstSizeLog2>* list, const T* valueSrc)
+{
+	SAssert(valueSrc);
+
+	T* dst = SegmentedListPushNew(list);
+	if (dst)
+		*dst = *valueSrc;
+	return dst;
+}
+
+template<typename T, u32 FirstSizeLog2>
+bool
+SegmentedListPop(SegmentedList<T, FirstSizeLog2>* list, T* valueDest)
+{
+	SAssert(list);
+
+	if (list->Count == 0)
+		return false;
+
+	if (valueDest)
+		*valueDest = *SegmentedListAt(list, list->Count - 1);
+	--list->Count;
+	return true;
+}
+
+// Moves the last element into idx, the only element whose address changes
+template<typename T, u32 FirstSizeLog2>
+bool
+SegmentedListRemoveAtFast(SegmentedList<T, FirstSizeLog2>* list, u32 idx)
+{
+	SAssert(list);
+
+	if (idx >= list->Count)
+		return false;
+
+	u32 last = list->Count - 1;
+	if (idx != last)
+		*SegmentedListAt(list, idx) = *SegmentedListAt(list, last);
+	--list->Count;
+	return true;
+}
+
+template<typename T, u32 FirstSizeLog2>
+_FORCE_INLINE_ void
+SegmentedListClear(SegmentedList<T, FirstSizeLog2>* list)
+{
+	SAssert(list);
+	list->Count = 0;
+}
+
+// Calls fn(T* element) for every element in order, a segment at a time
+template<typename T, u32 FirstSizeLog2, typename Fn>
+void
+SegmentedListForEach(SegmentedList<T, FirstSizeLog2>* list, Fn fn)
+{
+	SAssert(list);
+
+	u64 remaining = list->Count;
+	for (u32 segment = 0; remaining > 0; ++segment)
+	{
+		u64 segmentSize = SegmentedListSegmentSize(list, segment);
+		u64 count = Min(remaining, segmentSize);
+		T* elements = list->Segments[segment];
+		for (u64 i = 0; i < count; ++i)
+			fn(&elements[i]);
+		remaining -= count;
+	}
+}
+
+inline void TestSegmentedList()
+{
+	SegmentedList<u64, 2> list;
+	SegmentedListInitialize(&list, SAllocatorMalloc());
+
+	// 4 + 8 + 16 + 32 elements fill the first 4 segments
+	u64* pointers[60];
+	for (u64 i = 0; i < 60; ++i)
+	{
+		pointers[i] = SegmentedListPush(&list, &i);
+		SAssert(pointers[i]);
+	}
+	SAssert(list.SegmentCount == 4);
+	SAssert(SegmentedListCapacity(&list) == 60);
+
+	// Growing never moves anything
+	u64 value = 60;
+	SegmentedListPush(&list, &value);
+	SAssert(list.SegmentCount == 5);
+	for (u32 i = 0; i < 60; ++i)
+	{
+		SAssert(*pointers[i] == i);
+		SAssert(SegmentedListAt(&list, i) == pointers[i]);
+	}
+	SAssert(*SegmentedListAt(&list, 60) == 60);
+
+	u64 sum = 0;
+	SegmentedListForEach(&list, [&sum](u64* element) { sum += *element; });
+	SAssert(sum == 60 * 61 / 2);
+
+	bool removed = SegmentedListRemoveAtFast(&list, 3);
+	SAssert(removed);
+	SAssert(*pointers[3] == 60);
+	SAssert(list.Count == 60);
+
+	bool popped = SegmentedListPop(&list, &value);
+	SAssert(popped);
+	SAssert(value == 59);
+
+	// Clear keeps the segments
+	SegmentedListClear(&list);
+	SAssert(list.Count == 0);
+	u64* reused = SegmentedListPush(&list, &value);
+	SAssert(reused == pointers[0]);
+
+	SegmentedListDestroy(&list);
+	SAssert(list.SegmentCount == 0);
+}
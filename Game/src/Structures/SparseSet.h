@@ -93,9 +93,11 @@ struct SparseSet
 		SparseSetSize_t idx = Sparse[id];
 		SparseSetBucket<T>* lastBucket = Dense + Count - 1;
 
-		Sparse[lastBucket->Id] = EMPTY;
+		// Last bucket fills the hole, the removed id is kept past Count for reuse
+		Sparse[lastBucket->Id] = idx;
 		Dense[idx] = *lastBucket;
 		Dense[Count - 1].Id = id;
+		Sparse[id] = EMPTY;
 
 		--Count;
 	}
@@ -251,5 +253,6 @@ inline void TestSpareSet()
 
 	SAssert(*TestSet.Get(r) == 16);
 	SAssert(!TestSet.Get(rr));
+	SAssert(*TestSet.Get(rrr) == 64);
 	SAssert(TestSet.Count == 2);
 }
@@ -6,112 +6,232 @@
 #include "RenderUtils.h"
 #include "TileMap.h"
 #include "Regions.h"
+#include "Scratch.h"
 
 #include <raylib/src/raymath.h>
 
-void DrawEntities(ecs_iter_t* it)
+void DrawEntities(GameState* state, Rectangle screenRect)
 {
-	CTransform* transforms = ecs_field(it, CTransform, 1);
-	CRender* renders = ecs_field(it, CRender, 2);
+	Texture2D* texture = &state->AssetMgr.EntitySpriteSheet;
+	SpriteBatch* batch = &state->DrawBatch;
 
-	Texture2D* texture = &GetGameState()->AssetMgr.EntitySpriteSheet;
+	// Entities are bucketed by tile but can be drawn over a neighboring one
+	Rectangle queryRect = screenRect;
+	queryRect.x -= TILE_SIZE;
+	queryRect.y -= TILE_SIZE;
+	queryRect.width += TILE_SIZE * 2;
+	queryRect.height += TILE_SIZE * 2;
 
-	for (int i = 0; i < it->count; ++i)
+	// Grid cells are chunks, walk the entity list of each visible one
+	Vec2i min, max;
+	TileMapFixedGetChunkRange(&state->MainTileMap, queryRect, &min, &max);
+	for (int y = min.y; y <= max.y; ++y)
 	{
-		Sprite* sprite = SpriteGet(renders[i].SpriteId);
-		Rectangle dst;
-		dst.x = transforms[i].Pos.x;
-		dst.y = transforms[i].Pos.y;
-		dst.width = renders[i].Width;
-		dst.height = renders[i].Height;
-		DrawSprite(texture, sprite->CastRect(), dst, sprite->Origin, renders[i].Color, false);
+		for (int x = min.x; x <= max.x; ++x)
+		{
+			SList<SpatialEntry>* cell = SpatialGridGetCell(&state->EntityGrid, { x, y });
+			if (!cell)
+				continue;
+
+			for (u32 i = 0; i < cell->Count; ++i)
+			{
+				ecs_entity_t entity = cell->Memory[i].Entity;
+				const CRender* render = ecs_get(state->World, entity, CRender);
+				if (!render)
+					continue;
+
+				const CTransform* transform = ecs_get(state->World, entity, CTransform);
+				SAssert(transform);
+
+				// Ticks run at a fixed rate, interpolate between the last two
+				Vec2 pos = Vector2Lerp(transform->PrevPos, transform->Pos, state->TickAlpha);
+
+				Rectangle dst;
+				dst.x = pos.x;
+				dst.y = pos.y;
+				dst.width = render->Width;
+				dst.height = render->Height;
+				if (!CheckCollisionRecs(queryRect, dst))
+					continue;
+
+				Sprite* sprite = SpriteGet(render->SpriteId);
+				SpriteBatchPush(batch, texture, sprite->CastRect(), dst, sprite->Origin, render->Color, false);
+			}
+		}
 	}
 }
 
-void MoveSystem(ecs_iter_t* it)
+struct TileChangeEvent
 {
-	CTransform* transforms = ecs_field(it, CTransform, 1);
-	CMove* moves = ecs_field(it, CMove, 2);
+	ecs_entity_t Entity;
+	Vec2i OldTile;
+	Vec2i NewTile;
+};
 
-	HashMapT<Vec2i, ecs_entity_t>* entityMap = &GetGameState()->EntityMap;
+struct MoveJobData
+{
+	CTransform* Transforms;
+	CMove* Moves;
+	const ecs_entity_t* Entities;
+	TileChangeEvent* Events; // GroupSize slots per group, jobs in a group run serially
+	u32* EventCounts; // One per group
+	u32 GroupSize;
+	float BaseMS;
+};
 
-	float baseMS = 8.0f * it->delta_time;
-#if 1
-	for (int i = 0; i < it->count; ++i)
+// Smallest group size, grows when there are more groups than the job queues hold
+constant_var u32 MOVE_JOB_GROUP_SIZE = 64;
+
+// Only touches entity i's components and its group's event slots
+internal void
+InternalMoveEntity(MoveJobData* data, u32 i, u32 group)
+{
+	CTransform* transforms = data->Transforms;
+	CMove* moves = data->Moves;
+	float baseMS = data->BaseMS;
+
+	if (moves[i].IsCompleted)
+		return;
+
+	u8 pathType;
+	Vec2i target;
+	if (moves[i].MoveData.StartPath.Count > 0)
+	{
+		// Gets last index since paths are from back to front order
+		target = *moves[i].MoveData.StartPath.Last();
+		pathType = 0;
+	}
+	else if (moves[i].MoveData.Path.Count > 0)
+	{
+		RegionPath pathData = *moves[i].MoveData.Path.Last();
+		Region* region = GetRegion(pathData.RegionCoord);
+		SAssert(region);
+		u8 pathLength = region->PathLengths[(int)pathData.Direction];
+		Vec2i* path = region->PathPaths[(int)pathData.Direction];
+		SAssert(path);
+		target = path[pathLength - 1 - moves[i].MoveData.PathProgress];
+		pathType = 1;
+	}
+	else if (moves[i].MoveData.EndPath.Count > 0)
+	{
+		target = *moves[i].MoveData.EndPath.Last();
+		pathType = 2;
+	}
+	else
 	{
-		if (moves[i].IsCompleted)
-			continue;
+		moves[i].IsCompleted = true;
+		return;
+	}
 
-		u8 pathType;
-		Vec2i target;
-		if (moves[i].MoveData.StartPath.Count > 0)
-		{
-			// Gets last index since paths are from back to front order
-			target = *moves[i].MoveData.StartPath.Last();
-			pathType = 0;
-		}
-		else if (moves[i].MoveData.Path.Count > 0)
+	moves[i].Target = Vec2iToVec2(target) * Vec2 { TILE_SIZE, TILE_SIZE } + Vec2{ HALF_TILE_SIZE, HALF_TILE_SIZE };
+	transforms[i].Pos = Vector2Lerp(moves[i].Start, moves[i].Target, moves[i].Progress);
+	moves[i].Progress += baseMS;
+
+	if (moves[i].Progress > 1.0f)
+	{
+		moves[i].Progress = 0.0f;
+		moves[i].Start = moves[i].Target;
+		transforms[i].Pos = moves[i].Target;
+
+		if (pathType == 0)
+			--moves[i].MoveData.StartPath.Count;
+		else if (pathType == 1)
 		{
 			RegionPath pathData = *moves[i].MoveData.Path.Last();
 			Region* region = GetRegion(pathData.RegionCoord);
-			SAssert(region);
 			u8 pathLength = region->PathLengths[(int)pathData.Direction];
 			Vec2i* path = region->PathPaths[(int)pathData.Direction];
-			SAssert(path);
-			target = path[pathLength - 1 - moves[i].MoveData.PathProgress];
-			pathType = 1;
-		}
-		else if (moves[i].MoveData.EndPath.Count > 0)
-		{
-			target = *moves[i].MoveData.EndPath.Last();
-			pathType = 2;
-		}
-		else
-		{
-			moves[i].IsCompleted = true;
-			continue;
+			++moves[i].MoveData.PathProgress;
+			if (moves[i].MoveData.PathProgress == pathLength)
+			{
+				moves[i].MoveData.PathProgress = 0;
+				--moves[i].MoveData.Path.Count;
+			}
 		}
+		else if (pathType == 2)
+			--moves[i].MoveData.EndPath.Count;
+	}
 
-		moves[i].Target = Vec2iToVec2(target) * Vec2 { TILE_SIZE, TILE_SIZE } + Vec2{ HALF_TILE_SIZE, HALF_TILE_SIZE };
-		transforms[i].Pos = Vector2Lerp(moves[i].Start, moves[i].Target, moves[i].Progress);
-		moves[i].Progress += baseMS;
+	// Handle move to new tile, the grid is updated after all jobs finish
+	Vec2i travelTilePos = WorldToTile(transforms[i].Pos);
+	if (travelTilePos != transforms[i].TilePos)
+	{
+		TileChangeEvent* tileChange = &data->Events[group * data->GroupSize + data->EventCounts[group]];
+		++data->EventCounts[group];
+		tileChange->Entity = data->Entities[i];
+		tileChange->OldTile = transforms[i].TilePos;
+		tileChange->NewTile = travelTilePos;
 
-		if (moves[i].Progress > 1.0f)
-		{
-			moves[i].Progress = 0.0f;
-			moves[i].Start = moves[i].Target;
-			transforms[i].Pos = moves[i].Target;
+		transforms[i].TilePos = travelTilePos;
+	}
+}
 
-			if (pathType == 0)
-				--moves[i].MoveData.StartPath.Count;
-			else if (pathType == 1)
-			{
-				RegionPath pathData = *moves[i].MoveData.Path.Last();
-				Region* region = GetRegion(pathData.RegionCoord);
-				u8 pathLength = region->PathLengths[(int)pathData.Direction];
-				Vec2i* path = region->PathPaths[(int)pathData.Direction];
-				++moves[i].MoveData.PathProgress;
-				if (moves[i].MoveData.PathProgress == pathLength)
-				{
-					moves[i].MoveData.PathProgress = 0;
-					--moves[i].MoveData.Path.Count;
-				}
-			}
-			else if (pathType == 2)
-				--moves[i].MoveData.EndPath.Count;
-		}
+void TransformSnapshotSystem(ecs_iter_t* it)
+{
+	CTransform* transforms = ecs_field(it, CTransform, 1);
+	for (int i = 0; i < it->count; ++i)
+	{
+		transforms[i].PrevPos = transforms[i].Pos;
+	}
+}
 
-		// Handle move to new tile
-		Vec2i travelTilePos = WorldToTile(transforms[i].Pos);
-		if (travelTilePos != transforms[i].TilePos)
-		{
-			HashMapTRemove(entityMap, &transforms[i].TilePos);
-			HashMapTSet(entityMap, &travelTilePos, &it->entities[i]);
+void MoveSystem(ecs_iter_t* it)
+{
+	if (it->count == 0)
+		return;
+
+	double timerStart = SystemTimerBegin();
 
-			transforms[i].TilePos = travelTilePos;
+	u32 count = (u32)it->count;
+	// Every group is a job in a fixed size queue, bigger groups keep large counts from overflowing them
+	u32 groupSize = JobsDispatchGroupCount(count, JobsGetMaxDispatchGroups());
+	groupSize = Max(groupSize, MOVE_JOB_GROUP_SIZE);
+	u32 groupCount = JobsDispatchGroupCount(count, groupSize);
+
+	// Runs every tick, possibly several times a frame
+	ScratchScope scratch("MoveSystem");
+
+	MoveJobData data;
+	data.Transforms = ecs_field(it, CTransform, 1);
+	data.Moves = ecs_field(it, CMove, 2);
+	data.Entities = it->entities;
+	data.Events = (TileChangeEvent*)SAlloc(scratch.Allocator(), groupCount * groupSize * sizeof(TileChangeEvent));
+	data.EventCounts = (u32*)SAlloc(scratch.Allocator(), groupCount * sizeof(u32));
+	SZero(data.EventCounts, groupCount * sizeof(u32));
+	data.GroupSize = groupSize;
+	data.BaseMS = 8.0f * it->delta_time;
+
+	if (groupCount == 1)
+	{
+		// Not worth waking workers
+		for (u32 i = 0; i < count; ++i)
+			InternalMoveEntity(&data, i, 0);
+	}
+	else
+	{
+		JobHandle handle = {};
+		JobsDispatch(&handle, count, groupSize, [](JobArgs* args)
+					 {
+						 InternalMoveEntity((MoveJobData*)args->StackMemory, args->JobIndex, args->GroupId);
+					 }, &data);
+		JobHandleWait(&handle);
+	}
+
+	SystemTimerEnd(SYSTEM_TIMER_MOVE, timerStart);
+	timerStart = SystemTimerBegin();
+
+	// Serial merge, grid buckets aren't thread safe
+	SpatialGrid* entityGrid = &GetGameState()->EntityGrid;
+	for (u32 group = 0; group < groupCount; ++group)
+	{
+		TileChangeEvent* events = data.Events + group * groupSize;
+		for (u32 i = 0; i < data.EventCounts[group]; ++i)
+		{
+			SpatialGridMove(entityGrid, events[i].Entity, events[i].OldTile, events[i].NewTile);
 		}
 	}
-#endif
+
+	SystemTimerEnd(SYSTEM_TIMER_MOVE_MERGE, timerStart);
 }
 #if 0
 struct IntervalSystem
@@ -2,8 +2,51 @@
 
 #include "Core.h"
 
-void DrawEntities(ecs_iter_t* it);
+struct GameState;
+
+// Draws entities in chunks overlapping screenRect, others are never visited
+void DrawEntities(GameState* state, Rectangle screenRect);
+
+// Runs first every tick so anything that writes Pos, moving or not, interpolates from the tick's start
+void TransformSnapshotSystem(ecs_iter_t* it);
 
 void MoveSystem(ecs_iter_t* it);
 
+// Time accumulated per simulation system, reported by the headless build
+enum SystemTimerId : int
+{
+	SYSTEM_TIMER_TILEMAP,
+	SYSTEM_TIMER_MOVE,
+	SYSTEM_TIMER_MOVE_MERGE,
+
+	SYSTEM_TIMER_COUNT
+};
+
+struct SystemTimer
+{
+	const char* Name;
+	double Seconds;
+	u64 Calls;
+};
+
+inline SystemTimer SystemTimers[SYSTEM_TIMER_COUNT] =
+{
+	{ "TileMapFixedUpdate" },
+	{ "MoveSystem" },
+	{ "MoveSystemMerge" },
+};
+
+_FORCE_INLINE_ double
+SystemTimerBegin()
+{
+	return zpl_time_rel();
+}
+
+_FORCE_INLINE_ void
+SystemTimerEnd(SystemTimerId id, double start)
+{
+	SystemTimers[id].Seconds += zpl_time_rel() - start;
+	++SystemTimers[id].Calls;
+}
+
 void SystemUpdateActions(ecs_iter_t* it);
@@ -5,6 +5,7 @@
 #include "Memory.h"
 #include "GameState.h"
 #include "Utils.h"
+#include "Scratch.h"
 
 #define HashString(str, len) zpl_fnv32a(str, len);
 
@@ -29,9 +30,10 @@ SpriteAtlas SpriteAtlasLoad(const char* dirPath, const char* atlasFile)
 
 	int count = 0;
 	int bufferSize = Kilobytes(10);
-	char* buffer = (char*)SAlloc(SAllocatorFrame(), bufferSize);
+	ScratchScope scratch("SpriteAtlasLoad");
+	char* buffer = (char*)SAlloc(scratch.Allocator(), bufferSize);
 	int splitBufferSize = Kilobytes(1);
-	char** split = (char**)SAlloc(SAllocatorFrame(), splitBufferSize * sizeof(char*));
+	char** split = (char**)SAlloc(scratch.Allocator(), splitBufferSize * sizeof(char*));
 	TextSplitBuffered(atlasData, '\n', &count, buffer, bufferSize, split, splitBufferSize);
 
 	// 1st line empty
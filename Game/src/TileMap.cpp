@@ -31,17 +31,18 @@ internal void OnChunkUpdate(TileMap* tilemap, Chunk* chunk); // When a chunk upd
 internal Vec2i
 TileToChunk(Vec2i tile)
 {
+	// Arithmetic shift floors negative coords
 	Vec2i chunkCoord;
-	chunkCoord.x = (int)floorf((float)tile.x / (float)CHUNK_SIZE);
-	chunkCoord.y = (int)floorf((float)tile.y / (float)CHUNK_SIZE);
+	chunkCoord.x = tile.x >> CHUNK_SIZE_SHIFT;
+	chunkCoord.y = tile.y >> CHUNK_SIZE_SHIFT;
 	return chunkCoord;
 }
 
 internal size_t
 GetLocalTileIdx(Vec2i tile)
 {
-	int x = IntModNegative(tile.x, CHUNK_SIZE);
-	int y = IntModNegative(tile.y, CHUNK_SIZE);
+	int x = tile.x & CHUNK_SIZE_MASK;
+	int y = tile.y & CHUNK_SIZE_MASK;
 	size_t idx = (size_t)x + (size_t)y * CHUNK_SIZE;
 	SAssert(idx < CHUNK_AREA);
 	return idx;
@@ -97,7 +98,7 @@ TileMapFree(TileMap* tilemap)
 
 	for (u32 i = 0; i < tilemap->ChunkMap.Capacity; ++i)
 	{
-		if (tilemap->ChunkMap.Buckets[i].IsUsed)
+		if (HashMapTIsUsed(&tilemap->ChunkMap, i))
 		{
 			Chunk* chunk = tilemap->ChunkMap.Buckets[i].Value;
 			OnChunkUnload(tilemap, chunk);
@@ -149,7 +150,7 @@ TileMapUpdate(GameState* gameState, TileMap* tilemap)
 	// handles dirty chunks, and updates chunks.
 	for (u32 i = 0; i < tilemap->ChunkMap.Capacity; ++i)
 	{
-		if (!tilemap->ChunkMap.Buckets[i].IsUsed)
+		if (!HashMapTIsUsed(&tilemap->ChunkMap, i))
 			continue;
 
 		Chunk* chunk = tilemap->ChunkMap.Buckets[i].Value;
@@ -174,7 +175,7 @@ TileMapDraw(TileMap* tilemap, Rectangle screenRect)
 	SAssert(tilemap);
 	for (u32 i = 0; i < tilemap->ChunkMap.Capacity; ++i)
 	{
-		if (!tilemap->ChunkMap.Buckets[i].IsUsed)
+		if (!HashMapTIsUsed(&tilemap->ChunkMap, i))
 			continue;
 
 		Chunk* chunk = tilemap->ChunkMap.Buckets[i].Value;
@@ -567,7 +568,7 @@ ChunkThreadFunc(JobArgs* args)
 		if (chunkLoader->ChunksToRemove.Count >= MAX_CHUNKS_TO_PROCESS)
 			break;
 		
-		if (!tilemap->ChunkMap.Buckets[i].IsUsed)
+		if (!HashMapTIsUsed(&tilemap->ChunkMap, i))
 			continue;
 
 		Vec2i key = tilemap->ChunkMap.Buckets[i].Key;
@@ -37,6 +37,7 @@ InternalChunkGenerate(TileMapFixed* tilemap, ChunkFixed* chunk)
 			Tile fgTile = {};
 
 			chunk->TileArray[localIdx] = tile;
+			FixedChunkUpdateBitmaps(chunk, localIdx);
 		}
 	}
 }
@@ -52,22 +53,25 @@ void TileMapFixedCreate(TileMapFixed* tilemap, int length, int seed)
 	tilemap->Chunks.Reserve(SAllocatorGeneral(), length * length);
 	tilemap->Chunks.EnsureSize(SAllocatorGeneral(), length * length);
 	
+	tilemap->BakeQueue.Init(SAllocatorGeneral(), length * length);
+	ChunkTexturePoolCreate(&tilemap->TexturePool, SAllocatorGeneral(), CHUNK_TEXTURE_POOL_SIZE, CHUNK_SIZE_PIXELS, ChunkTextureBackendRaylib());
+
 	tilemap->NoiseState = fnlCreateState();
 	tilemap->NoiseState.noise_type = FNL_NOISE_OPENSIMPLEX2;
 
-	int size = TILE_SIZE * CHUNK_SIZE;
 	for (u32 i = 0; i < tilemap->Chunks.Count; ++i)
 	{
 		ChunkFixed* chunk = tilemap->Chunks.At(i);
 		*chunk = {};
-		chunk->Coord.x = (int)i / length;
-		chunk->Coord.y = (int)i % length;
+		// Matches FixedChunkGetByCoord's index
+		chunk->Coord.x = (int)i % length;
+		chunk->Coord.y = (int)i / length;
 		chunk->BoundingBox.x = (float)chunk->Coord.x * CHUNK_SIZE_PIXELS;
 		chunk->BoundingBox.y = (float)chunk->Coord.y * CHUNK_SIZE_PIXELS;
 		chunk->BoundingBox.width = CHUNK_SIZE_PIXELS;
 		chunk->BoundingBox.height = CHUNK_SIZE_PIXELS;
-		chunk->RenderTexture = LoadRenderTextureEx({ size, size}, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, false);
-		chunk->BakeState = ChunkUpdateState::Self;
+		// Baked once a texture is assigned
+		chunk->TextureSlot = CHUNK_TEXTURE_INVALID_SLOT;
 		chunk->UpdateState = ChunkUpdateState::SelfAndNeighbors;
 		chunk->IsLoaded = true;
 
@@ -82,11 +86,192 @@ void TileMapFixedLoad(TileMapFixed* tilemap, GameState* state, String path)
 
 void TileMapFixedUnload(TileMapFixed* tilemap, GameState* state)
 {
-	for (u32 i = 0; i < tilemap->Chunks.Count; ++i)
+	ChunkTexturePoolDestroy(&tilemap->TexturePool);
+	tilemap->Chunks.Free();
+	tilemap->BakeQueue.Free();
+}
+
+// Returns true if walkability of the tile changed
+internal bool
+InternalApplyEdit(ChunkFixed* chunk, size_t idx, const TileEdit* edit)
+{
+	Tile* dst = &chunk->TileArray[idx];
+	bool wasSolid = dst->Flags.Get(TILE_FLAG_COLLISION);
+
+	switch (edit->Type)
 	{
-		UnloadRenderTexture(tilemap->Chunks.Memory[i].RenderTexture);
+	case(TileEditType::Tile): *dst = edit->Value; break;
+	case(TileEditType::Background): dst->BackgroundId = edit->Value.BackgroundId; break;
+	case(TileEditType::Foreground): dst->ForegroundId = edit->Value.ForegroundId; break;
+	default: SAssertMsg(false, "Invalid TileEditType"); break;
 	}
-	tilemap->Chunks.Free();
+
+	FixedChunkUpdateBitmaps(chunk, idx);
+	return wasSolid != dst->Flags.Get(TILE_FLAG_COLLISION);
+}
+
+// Regions check one tile across their sides, a collision change on a chunk
+// border tile also invalidates the regions of the neighbors it touches.
+internal int
+InternalGetBorderNeighbors(TileMapFixed* tilemap, Vec2i tile, ChunkFixed* outNeighbors[2])
+{
+	int localX = tile.x & CHUNK_SIZE_MASK;
+	int localY = tile.y & CHUNK_SIZE_MASK;
+	Vec2i chunkCoord = FixedChunkTileToChunk(tile);
+
+	Vec2i coords[2];
+	int coordCount = 0;
+	if (localX == 0) coords[coordCount++] = chunkCoord + Vec2i_LEFT;
+	else if (localX == CHUNK_SIZE - 1) coords[coordCount++] = chunkCoord + Vec2i_RIGHT;
+	if (localY == 0) coords[coordCount++] = chunkCoord + Vec2i_UP;
+	else if (localY == CHUNK_SIZE - 1) coords[coordCount++] = chunkCoord + Vec2i_DOWN;
+
+	int count = 0;
+	for (int i = 0; i < coordCount; ++i)
+	{
+		ChunkFixed* neighbor = FixedChunkGetByCoord(tilemap, coords[i]);
+		if (neighbor)
+			outNeighbors[count++] = neighbor;
+	}
+	return count;
+}
+
+internal void
+InternalMarkRegionsDirty(ChunkFixed* chunk)
+{
+	if (chunk->UpdateState == ChunkUpdateState::None)
+		chunk->UpdateState = ChunkUpdateState::Self;
+}
+
+_FORCE_INLINE_ internal RectI
+InternalTileBakeRect(Vec2i tile)
+{
+	return { tile.x & CHUNK_SIZE_MASK, tile.y & CHUNK_SIZE_MASK, 1, 1 };
+}
+
+void
+SetTile(TileMapFixed* tilemap, Vec2i tile, const Tile* src)
+{
+	SAssert(tilemap);
+	SAssert(src);
+	ChunkFixed* chunk = FixedChunkGetByTile(tilemap, tile);
+	if (chunk)
+	{
+		TileEdit edit;
+		edit.Coord = tile;
+		edit.Value = *src;
+		edit.Type = TileEditType::Tile;
+		bool collisionChanged = InternalApplyEdit(chunk, FixedChunkGetLocalTileIdx(tile), &edit);
+
+		FixedChunkAddBakeRect(chunk, InternalTileBakeRect(tile));
+
+		// Regions only care about walkability
+		if (collisionChanged)
+		{
+			InternalMarkRegionsDirty(chunk);
+
+			ChunkFixed* neighbors[2];
+			int neighborCount = InternalGetBorderNeighbors(tilemap, tile, neighbors);
+			for (int i = 0; i < neighborCount; ++i)
+				InternalMarkRegionsDirty(neighbors[i]);
+		}
+	}
+}
+
+void
+TileEditBatchBegin(TileEditBatch* batch, TileMapFixed* tilemap, SAllocator allocator, u32 capacity)
+{
+	SAssert(batch);
+	SAssert(tilemap);
+	*batch = {};
+	batch->Tilemap = tilemap;
+	batch->Edits.Reserve(allocator, Max(capacity, 1u));
+}
+
+void
+TileEditBatchSet(TileEditBatch* batch, Vec2i tile, const Tile* src)
+{
+	SAssert(batch);
+	SAssert(src);
+	TileEdit* edit = batch->Edits.PushNew();
+	edit->Coord = tile;
+	edit->Value = *src;
+	edit->Type = TileEditType::Tile;
+}
+
+void
+TileEditBatchSetId(TileEditBatch* batch, Vec2i tile, u16 id, short layer)
+{
+	SAssert(batch);
+	SAssertMsg(layer == 0 || layer == 1, "TileEditBatchSetId using invalid layer.");
+	TileEdit* edit = batch->Edits.PushNew();
+	edit->Coord = tile;
+	edit->Value = {};
+	if (layer == 0)
+	{
+		edit->Value.BackgroundId = id;
+		edit->Type = TileEditType::Background;
+	}
+	else
+	{
+		edit->Value.ForegroundId = id;
+		edit->Type = TileEditType::Foreground;
+	}
+}
+
+void
+TileEditBatchCommit(TileEditBatch* batch)
+{
+	SAssert(batch);
+	SAssert(batch->Tilemap);
+	TileMapFixed* tilemap = batch->Tilemap;
+
+	if (batch->Edits.Count > 0)
+	{
+		// Chunks needing region rebuilds, marked once after all edits are applied.
+		// Bake rects are merged per edit, the chunk is still only baked once.
+		u32 chunkCount = tilemap->Chunks.Count;
+		bool* regionsDirty = (bool*)SAlloc(SAllocatorFrame(), chunkCount * sizeof(bool));
+		memset(regionsDirty, 0, chunkCount * sizeof(bool));
+
+		TileCursor cursor = TileCursorCreate(tilemap);
+		for (u32 i = 0; i < batch->Edits.Count; ++i)
+		{
+			TileEdit* edit = batch->Edits.At(i);
+			ChunkFixed* chunk = TileCursorSeek(&cursor, edit->Coord);
+			if (!chunk)
+				continue;
+
+			FixedChunkAddBakeRect(chunk, InternalTileBakeRect(edit->Coord));
+
+			if (InternalApplyEdit(chunk, FixedChunkGetLocalTileIdx(edit->Coord), edit))
+			{
+				regionsDirty[chunk - tilemap->Chunks.Memory] = true;
+
+				ChunkFixed* neighbors[2];
+				int neighborCount = InternalGetBorderNeighbors(tilemap, edit->Coord, neighbors);
+				for (int j = 0; j < neighborCount; ++j)
+					regionsDirty[neighbors[j] - tilemap->Chunks.Memory] = true;
+			}
+		}
+
+		for (u32 i = 0; i < chunkCount; ++i)
+		{
+			if (regionsDirty[i])
+				InternalMarkRegionsDirty(tilemap->Chunks.At(i));
+		}
+	}
+
+	TileEditBatchCancel(batch);
+}
+
+void
+TileEditBatchCancel(TileEditBatch* batch)
+{
+	SAssert(batch);
+	if (batch->Edits.Memory)
+		batch->Edits.Free();
+	batch->Edits = {};
 }
 
 internal void 
@@ -106,8 +291,8 @@ ChunkTick(GameState* gameState, TileMapFixed* tilemap, ChunkFixed* chunk)
 				if (!neighborChunk)
 					continue;
 				
-				if (bakeNeighbors && neighborChunk->BakeState == ChunkUpdateState::None)
-					neighborChunk->BakeState = ChunkUpdateState::Self;
+				if (bakeNeighbors)
+					FixedChunkAddBakeRect(neighborChunk, CHUNK_BAKE_RECT_FULL);
 
 				if (updateNeighbors && neighborChunk->UpdateState == ChunkUpdateState::None)
 					neighborChunk->UpdateState = ChunkUpdateState::Self;
@@ -125,15 +310,40 @@ OnChunkUpdate(GameState* gameState, ChunkFixed* chunk)
 	RegionLoad(&gameState->MainTileMap, chunk->Coord);
 }
 
-internal void
-OnChunkBake(GameState* gameState, ChunkFixed* chunk)
+_FORCE_INLINE_ internal u32
+InternalChunkIndex(TileMapFixed* tilemap, ChunkFixed* chunk)
 {
+	return (u32)(chunk - tilemap->Chunks.Memory);
+}
+
+// Returns number of tiles drawn
+internal int
+OnChunkBake(TileMapFixed* tilemap, ChunkFixed* chunk)
+{
+	RectI rect = chunk->BakeRect;
+	chunk->BakeRect = {};
+	if (rect.w <= 0 || rect.h <= 0)
+		return 0;
+
+	// Chunks without a texture get fully baked when they are assigned one
+	RenderTexture2D* renderTexture = ChunkTexturePoolGet(&tilemap->TexturePool, InternalChunkIndex(tilemap, chunk), chunk->TextureSlot);
+	if (!renderTexture)
+		return 0;
+
 	Texture2D* tileSpriteSheet = GetTileSheet();
+	SpriteBatch* batch = &GetGameState()->DrawBatch;
 
-	BeginTextureMode(chunk->RenderTexture);
-	for (int y = 0; y < CHUNK_SIZE; ++y)
+	BeginTextureMode(*renderTexture);
+
+	// Only the dirty rect is cleared, tiles with transparency would
+	// otherwise blend over what was baked before
+	BeginScissorMode(rect.x * TILE_SIZE, rect.y * TILE_SIZE, rect.w * TILE_SIZE, rect.h * TILE_SIZE);
+	ClearBackground(BLANK);
+	EndScissorMode();
+
+	for (int y = rect.y; y < rect.y + rect.h; ++y)
 	{
-		for (int x = 0; x < CHUNK_SIZE; ++x)
+		for (int x = rect.x; x < rect.x + rect.w; ++x)
 		{
 			int localIdx = x + y * CHUNK_SIZE;
 
@@ -145,16 +355,47 @@ OnChunkBake(GameState* gameState, ChunkFixed* chunk)
 			Rectangle src = GetTileDef(tile->BackgroundId)->SpriteSheetRect;
 			Rectangle dst = { posX, posY, TILE_SIZE, TILE_SIZE };
 			
-			DrawTexturePro(*tileSpriteSheet, src, dst, {}, 0, WHITE);
+			SpriteBatchPush(batch, tileSpriteSheet, src, dst, {}, WHITE, false);
 
 			if (tile->ForegroundId > 0)
 			{
 				src = GetTileDef(tile->ForegroundId)->SpriteSheetRect;
-				DrawTexturePro(*tileSpriteSheet, src, dst, {}, 0, WHITE);
+				SpriteBatchPush(batch, tileSpriteSheet, src, dst, {}, WHITE, false);
 			}
 		}
 	}
+	SpriteBatchFlush(batch);
 	EndTextureMode();
+
+	return rect.w * rect.h;
+}
+
+internal void
+InternalQueueBake(TileMapFixed* tilemap, ChunkFixed* chunk)
+{
+	if (!chunk->IsInBakeQueue)
+	{
+		u32 chunkIdx = InternalChunkIndex(tilemap, chunk);
+		chunk->IsInBakeQueue = true;
+		bool wasPushed = tilemap->BakeQueue.PushLast(&chunkIdx);
+		SAssert(wasPushed);
+	}
+}
+
+// Bakes queued chunks until CHUNK_BAKE_TILE_BUDGET tiles were drawn this frame
+internal void
+ProcessBakeQueue(TileMapFixed* tilemap)
+{
+	int tilesBaked = 0;
+	while (!tilemap->BakeQueue.IsEmpty() && tilesBaked < CHUNK_BAKE_TILE_BUDGET)
+	{
+		u32 chunkIdx = *tilemap->BakeQueue.PeekFirst();
+		tilemap->BakeQueue.PopFirst();
+
+		ChunkFixed* chunk = tilemap->Chunks.At(chunkIdx);
+		chunk->IsInBakeQueue = false;
+		tilesBaked += OnChunkBake(tilemap, chunk);
+	}
 }
 
 void TileMapFixedUpdate(TileMapFixed* tilemap, GameState* state)
@@ -165,7 +406,7 @@ void TileMapFixedUpdate(TileMapFixed* tilemap, GameState* state)
 
 		if (chunk->BakeState != ChunkUpdateState::None)
 		{
-			OnChunkBake(state, chunk);
+			InternalQueueBake(tilemap, chunk);
 		}
 
 		if (chunk->UpdateState != ChunkUpdateState::None)
@@ -177,13 +418,80 @@ void TileMapFixedUpdate(TileMapFixed* tilemap, GameState* state)
 	}
 }
 
+// Inclusive range of chunk coords overlapping a world rect, clamped to the map
+void TileMapFixedGetChunkRange(TileMapFixed* tilemap, Rectangle rect, Vec2i* outMin, Vec2i* outMax)
+{
+	int last = tilemap->LengthInChunks - 1;
+	int minX = (int)floorf(rect.x / CHUNK_SIZE_PIXELS);
+	int minY = (int)floorf(rect.y / CHUNK_SIZE_PIXELS);
+	int maxX = (int)floorf((rect.x + rect.width) / CHUNK_SIZE_PIXELS);
+	int maxY = (int)floorf((rect.y + rect.height) / CHUNK_SIZE_PIXELS);
+	outMin->x = Max(minX, 0);
+	outMin->y = Max(minY, 0);
+	outMax->x = Min(maxX, last);
+	outMax->y = Min(maxY, last);
+}
+
+// Chunks a texture is assigned to get a full rebake, visible ones right away
+internal void
+InternalAcquireTextures(TileMapFixed* tilemap, Rectangle rect, bool bakeNow)
+{
+	Vec2i min, max;
+	TileMapFixedGetChunkRange(tilemap, rect, &min, &max);
+	for (int y = min.y; y <= max.y; ++y)
+	{
+		for (int x = min.x; x <= max.x; ++x)
+		{
+			ChunkFixed* chunk = FixedChunkGetByCoord(tilemap, { x, y });
+			SAssert(chunk);
+
+			bool wasAssigned;
+			chunk->TextureSlot = ChunkTexturePoolAcquire(&tilemap->TexturePool, InternalChunkIndex(tilemap, chunk), chunk->TextureSlot, &wasAssigned);
+			if (wasAssigned)
+			{
+				chunk->BakeRect = CHUNK_BAKE_RECT_FULL;
+				if (bakeNow)
+					OnChunkBake(tilemap, chunk);
+				else
+					InternalQueueBake(tilemap, chunk);
+			}
+		}
+	}
+}
+
+void TileMapFixedUpdateTextures(TileMapFixed* tilemap, Rectangle screenRect)
+{
+	ChunkTexturePoolNextFrame(&tilemap->TexturePool);
+
+	// Visible chunks first so prefetching can't take their slots
+	InternalAcquireTextures(tilemap, screenRect, true);
+
+	Rectangle prefetchRect = screenRect;
+	prefetchRect.x -= CHUNK_SIZE_PIXELS;
+	prefetchRect.y -= CHUNK_SIZE_PIXELS;
+	prefetchRect.width += CHUNK_SIZE_PIXELS * 2;
+	prefetchRect.height += CHUNK_SIZE_PIXELS * 2;
+	InternalAcquireTextures(tilemap, prefetchRect, false);
+
+	ProcessBakeQueue(tilemap);
+}
+
 void TileMapFixedDraw(TileMapFixed* tilemap, Rectangle screenRect)
 {
-	for (u32 i = 0; i < tilemap->Chunks.Count; ++i)
+	Vec2i min, max;
+	TileMapFixedGetChunkRange(tilemap, screenRect, &min, &max);
+	for (int y = min.y; y <= max.y; ++y)
 	{
-		ChunkFixed* chunk = tilemap->Chunks.At(i);
-		if (CheckCollisionRecs(chunk->BoundingBox, screenRect))
+		for (int x = min.x; x <= max.x; ++x)
 		{
+			ChunkFixed* chunk = FixedChunkGetByCoord(tilemap, { x, y });
+			SAssert(chunk);
+
+			// No texture if the pool ran out of slots this frame
+			RenderTexture2D* renderTexture = ChunkTexturePoolGet(&tilemap->TexturePool, InternalChunkIndex(tilemap, chunk), chunk->TextureSlot);
+			if (!renderTexture)
+				continue;
+
 			Rectangle src =
 			{
 				0,
@@ -191,8 +499,175 @@ void TileMapFixedDraw(TileMapFixed* tilemap, Rectangle screenRect)
 				CHUNK_SIZE_PIXELS,
 				-CHUNK_SIZE_PIXELS
 			};
-			SAssert(chunk->RenderTexture.texture.id != 0);
-			DrawTexturePro(chunk->RenderTexture.texture, src, chunk->BoundingBox, {}, 0, WHITE);
+			SAssert(renderTexture->texture.id != 0);
+			DrawTexturePro(renderTexture->texture, src, chunk->BoundingBox, {}, 0, WHITE);
+		}
+	}
+}
+
+// *************
+// Benchmark
+
+// Tile lookup before shift/mask coords, kept to compare against
+internal Tile*
+LegacyGetTile(TileMapFixed* tilemap, Vec2i tile)
+{
+	Vec2i chunkCoord;
+	chunkCoord.x = (int)floorf((float)tile.x / (float)CHUNK_SIZE);
+	chunkCoord.y = (int)floorf((float)tile.y / (float)CHUNK_SIZE);
+	ChunkFixed* chunk = FixedChunkGetByCoord(tilemap, chunkCoord);
+	if (!chunk)
+		return nullptr;
+
+	int x = IntModNegative(tile.x, CHUNK_SIZE);
+	int y = IntModNegative(tile.y, CHUNK_SIZE);
+	return &chunk->TileArray[x + y * CHUNK_SIZE];
+}
+
+void TileMapFixedBenchmarkAccess(TileMapFixed* tilemap, int passes)
+{
+	SAssert(tilemap);
+	SAssert(passes > 0);
+
+	// Visits every tile and its 8 neighbors, same access pattern as FindPath
+	int length = tilemap->LengthInChunks * CHUNK_SIZE;
+	u64 lookups = (u64)length * (u64)length * ArrayLength(Vec2i_NEIGHTBORS) * (u64)passes;
+	u64 checksums[3] = {};
+	u64 cycles[3] = {};
+
+	u64 start = zpl_rdtsc();
+	for (int pass = 0; pass < passes; ++pass)
+		for (int y = 0; y < length; ++y)
+			for (int x = 0; x < length; ++x)
+				for (size_t i = 0; i < ArrayLength(Vec2i_NEIGHTBORS); ++i)
+				{
+					Tile* tile = LegacyGetTile(tilemap, Vec2i{ x, y } + Vec2i_NEIGHTBORS[i]);
+					if (tile)
+						checksums[0] += tile->BackgroundId;
+				}
+	cycles[0] = zpl_rdtsc() - start;
+
+	start = zpl_rdtsc();
+	for (int pass = 0; pass < passes; ++pass)
+		for (int y = 0; y < length; ++y)
+			for (int x = 0; x < length; ++x)
+				for (size_t i = 0; i < ArrayLength(Vec2i_NEIGHTBORS); ++i)
+				{
+					Tile* tile = GetTile(tilemap, Vec2i{ x, y } + Vec2i_NEIGHTBORS[i]);
+					if (tile)
+						checksums[1] += tile->BackgroundId;
+				}
+	cycles[1] = zpl_rdtsc() - start;
+
+	start = zpl_rdtsc();
+	TileCursor cursor = TileCursorCreate(tilemap);
+	for (int pass = 0; pass < passes; ++pass)
+		for (int y = 0; y < length; ++y)
+			for (int x = 0; x < length; ++x)
+				for (size_t i = 0; i < ArrayLength(Vec2i_NEIGHTBORS); ++i)
+				{
+					Tile* tile = TileCursorGet(&cursor, Vec2i{ x, y } + Vec2i_NEIGHTBORS[i]);
+					if (tile)
+						checksums[2] += tile->BackgroundId;
+				}
+	cycles[2] = zpl_rdtsc() - start;
+
+	SAssertMsg(checksums[0] == checksums[1] && checksums[1] == checksums[2], "Tile lookups disagree");
+
+	constexpr const char* NAMES[] = { "Legacy float", "GetTile", "TileCursor" };
+	for (int i = 0; i < 3; ++i)
+	{
+		double perLookup = (double)cycles[i] / (double)lookups;
+		double speedup = (double)cycles[0] / (double)Max(cycles[i], 1ull);
+		SInfoLog("[ Benchmark ] %s: %llu lookups, %.2f cycles/lookup, %.2fx", NAMES[i], lookups, perLookup, speedup);
+	}
+}
+
+void TestTileEditBatch()
+{
+	// 3x3 chunks of empty tiles, no textures or regions
+	TileMapFixed tilemap = {};
+	tilemap.LengthInChunks = 3;
+	tilemap.Chunks.Reserve(SAllocatorMalloc(), 9);
+	tilemap.Chunks.EnsureSize(SAllocatorMalloc(), 9);
+	tilemap.BakeQueue.Init(SAllocatorMalloc(), 16);
+	for (u32 i = 0; i < tilemap.Chunks.Count; ++i)
+	{
+		ChunkFixed* chunk = tilemap.Chunks.At(i);
+		*chunk = {};
+		chunk->Coord.x = (int)i % tilemap.LengthInChunks;
+		chunk->Coord.y = (int)i / tilemap.LengthInChunks;
+	}
+
+	ChunkFixed* topLeft = FixedChunkGetByCoord(&tilemap, { 0, 0 });
+	ChunkFixed* topMiddle = FixedChunkGetByCoord(&tilemap, { 1, 0 });
+	ChunkFixed* center = FixedChunkGetByCoord(&tilemap, { 1, 1 });
+
+	Tile wall = {};
+	wall.Flags.Set(TILE_FLAG_COLLISION, true);
+
+	// Cancel leaves tiles and dirty state alone
+	TileEditBatch batch;
+	TileEditBatchBegin(&batch, &tilemap, SAllocatorMalloc(), 4);
+	TileEditBatchSet(&batch, { 4, 4 }, &wall);
+	TileEditBatchSetId(&batch, { 5, 4 }, 7, 0);
+	TileEditBatchCancel(&batch);
+	SAssert(!GetTile(&tilemap, { 4, 4 })->Flags.Get(TILE_FLAG_COLLISION));
+	SAssert(GetTile(&tilemap, { 5, 4 })->BackgroundId == 0);
+	SAssert(topLeft->BakeState == ChunkUpdateState::None && topLeft->BakeRect.w == 0);
+	SAssert(topLeft->UpdateState == ChunkUpdateState::None);
+	SAssert(batch.Edits.Count == 0);
+
+	// A wall across the border of the top two chunks, a background change on
+	// the top left's bottom border and a wall on the top middle's bottom border
+	TileEditBatchBegin(&batch, &tilemap, SAllocatorMalloc(), 16);
+	for (int x = CHUNK_SIZE - 4; x < CHUNK_SIZE + 4; ++x)
+		TileEditBatchSet(&batch, { x, 5 }, &wall);
+	TileEditBatchSetId(&batch, { 5, CHUNK_SIZE - 1 }, 7, 0);
+	TileEditBatchSet(&batch, { CHUNK_SIZE + 5, CHUNK_SIZE - 1 }, &wall);
+	TileEditBatchCommit(&batch);
+	SAssert(batch.Edits.Count == 0);
+
+	SAssert(GetTile(&tilemap, { CHUNK_SIZE - 1, 5 })->Flags.Get(TILE_FLAG_COLLISION));
+	SAssert(GetTile(&tilemap, { CHUNK_SIZE, 5 })->Flags.Get(TILE_FLAG_COLLISION));
+	SAssert(GetTile(&tilemap, { 5, CHUNK_SIZE - 1 })->BackgroundId == 7);
+
+	// Bake rects cover every edit in the chunk
+	RectI rect = topLeft->BakeRect;
+	SAssert(rect.x == 5 && rect.y == 5 && rect.w == CHUNK_SIZE - 5 && rect.h == CHUNK_SIZE - 5);
+	rect = topMiddle->BakeRect;
+	SAssert(rect.x == 0 && rect.y == 5 && rect.w == 6 && rect.h == CHUNK_SIZE - 5);
+
+	// Regions of the walled chunks and of the neighbor below the bottom border
+	// wall, the background change touches no regions
+	for (u32 i = 0; i < tilemap.Chunks.Count; ++i)
+	{
+		ChunkFixed* chunk = tilemap.Chunks.At(i);
+		bool isBaked = (chunk == topLeft || chunk == topMiddle);
+		bool isRegionDirty = isBaked || chunk == center;
+		SAssert((chunk->BakeState != ChunkUpdateState::None) == isBaked);
+		SAssert((chunk->UpdateState != ChunkUpdateState::None) == isRegionDirty);
+	}
+
+	// Queued like TileMapFixedUpdate does, twice over with another edit in
+	// between, each baked chunk is still in the queue once
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		for (u32 i = 0; i < tilemap.Chunks.Count; ++i)
+		{
+			ChunkFixed* chunk = tilemap.Chunks.At(i);
+			if (chunk->BakeState != ChunkUpdateState::None)
+				InternalQueueBake(&tilemap, chunk);
 		}
+
+		TileEditBatchBegin(&batch, &tilemap, SAllocatorMalloc(), 1);
+		TileEditBatchSetId(&batch, { 6, 6 }, 8, 1);
+		TileEditBatchCommit(&batch);
 	}
+	SAssert(tilemap.BakeQueue.Count == 2);
+	SAssert(*tilemap.BakeQueue.At(0) == InternalChunkIndex(&tilemap, topLeft));
+	SAssert(*tilemap.BakeQueue.At(1) == InternalChunkIndex(&tilemap, topMiddle));
+
+	tilemap.BakeQueue.Free();
+	tilemap.Chunks.Free();
 }
@@ -2,10 +2,12 @@
 
 #include "Core.h"
 #include "Tile.h"
+#include "ChunkTexturePool.h"
 #include "TileMap.h"
 #include "Structures/StaticArray.h"
 #include "Structures/HashMapT.h"
 #include "Structures/SList.h"
+#include "Structures/Queue.h"
 #include "Lib/String.h"
 #include "Lib/Jobs.h"
 
@@ -13,19 +15,32 @@
 
 struct ChunkFixed
 {
-	RenderTexture2D RenderTexture;
 	Rectangle BoundingBox;
 	Vec2i Coord;
+	RectI BakeRect; // Local tiles to redraw on next bake, empty if clean
+	int TextureSlot; // Slot in TileMapFixed::TexturePool, may have been evicted
 	ChunkUpdateState BakeState;
 	ChunkUpdateState UpdateState;
 	bool IsGenerated;
 	bool IsLoaded; // TODO do we just remove this?
+	bool IsInBakeQueue;
 	Tile TileArray[CHUNK_AREA];
+	// One u32 row per local y, bit x set if tile has the flag.
+	// Kept in sync with TileArray so queries can test whole rows.
+	u32 CollisionBitmap[CHUNK_SIZE];
+	u32 BlocksLightBitmap[CHUNK_SIZE];
 };
+static_assert(CHUNK_SIZE == 32, "Chunk bitmaps expect 32 tiles per row");
+
+// Max tiles redrawn per frame, first bake in the queue always runs
+constant_var int CHUNK_BAKE_TILE_BUDGET = CHUNK_AREA * 4;
+constant_var RectI CHUNK_BAKE_RECT_FULL = { 0, 0, CHUNK_SIZE, CHUNK_SIZE };
 
 struct TileMapFixed
 {
 	SList<ChunkFixed> Chunks;
+	Queue<u32> BakeQueue; // Chunk indices waiting for OnChunkBake
+	ChunkTexturePool TexturePool;
 	fnl_state NoiseState;
 	int LengthInChunks;
 	int Seed;
@@ -35,23 +50,69 @@ void TileMapFixedCreate(TileMapFixed* tilemap, int length, int seed);
 void TileMapFixedLoad(TileMapFixed* tilemap, GameState* state, String path);
 void TileMapFixedUnload(TileMapFixed* tilemap, GameState* state);
 
+void SetTile(TileMapFixed* tilemap, Vec2i tile, const Tile* src);
+
 void TileMapFixedUpdate(TileMapFixed* tilemap, GameState* state);
+// Assigns pooled textures to chunks near screenRect and bakes queued chunks.
+// Call once per frame outside of any texture or 2D mode.
+void TileMapFixedUpdateTextures(TileMapFixed* tilemap, Rectangle screenRect);
 void TileMapFixedDraw(TileMapFixed* tilemap, Rectangle screenRect);
 
+// Inclusive chunk coords overlapping rect, clamped to the map. min > max if none overlap.
+void TileMapFixedGetChunkRange(TileMapFixed* tilemap, Rectangle rect, Vec2i* outMin, Vec2i* outMax);
+
+// *************
+// TileEditBatch
+// Records tile edits and applies them together on commit. Every touched chunk is
+// rebaked once, region rebuilds only happen for chunks whose collision changed
+// and for neighbors sharing a changed border tile.
+
+enum class TileEditType : u8
+{
+	Tile,
+	Background,
+	Foreground
+};
+
+struct TileEdit
+{
+	Vec2i Coord;
+	Tile Value;
+	TileEditType Type;
+};
+
+struct TileEditBatch
+{
+	TileMapFixed* Tilemap;
+	SList<TileEdit> Edits;
+};
+
+void TileEditBatchBegin(TileEditBatch* batch, TileMapFixed* tilemap, SAllocator allocator, u32 capacity);
+void TileEditBatchSet(TileEditBatch* batch, Vec2i tile, const Tile* src);
+void TileEditBatchSetId(TileEditBatch* batch, Vec2i tile, u16 id, short layer);
+void TileEditBatchCommit(TileEditBatch* batch);
+void TileEditBatchCancel(TileEditBatch* batch);
+
+void TestTileEditBatch();
+
+// Logs timings of neighbor tile lookups using the old float path, GetTile and a TileCursor
+void TileMapFixedBenchmarkAccess(TileMapFixed* tilemap, int passes);
+
 inline Vec2i
 FixedChunkTileToChunk(Vec2i tile)
 {
+	// Arithmetic shift floors negative coords
 	Vec2i chunkCoord;
-	chunkCoord.x = (int)floorf((float)tile.x / (float)CHUNK_SIZE);
-	chunkCoord.y = (int)floorf((float)tile.y / (float)CHUNK_SIZE);
+	chunkCoord.x = tile.x >> CHUNK_SIZE_SHIFT;
+	chunkCoord.y = tile.y >> CHUNK_SIZE_SHIFT;
 	return chunkCoord;
 }
 
 inline size_t
 FixedChunkGetLocalTileIdx(Vec2i tile)
 {
-	int x = IntModNegative(tile.x, CHUNK_SIZE);
-	int y = IntModNegative(tile.y, CHUNK_SIZE);
+	int x = tile.x & CHUNK_SIZE_MASK;
+	int y = tile.y & CHUNK_SIZE_MASK;
 	size_t idx = (size_t)x + (size_t)y * CHUNK_SIZE;
 	SAssert(idx < CHUNK_AREA);
 	return idx;
@@ -105,3 +166,191 @@ GetTile(TileMapFixed* tilemap, Vec2i tile)
 	else
 		return nullptr;
 }
+
+inline void
+FixedChunkUpdateBitmaps(ChunkFixed* chunk, size_t localIdx)
+{
+	SAssert(chunk);
+	SAssert(localIdx < CHUNK_AREA);
+	size_t x = localIdx % CHUNK_SIZE;
+	size_t y = localIdx / CHUNK_SIZE;
+	u32 bit = 1u << x;
+	Tile* tile = &chunk->TileArray[localIdx];
+
+	if (tile->Flags.Get(TILE_FLAG_COLLISION))
+		chunk->CollisionBitmap[y] |= bit;
+	else
+		chunk->CollisionBitmap[y] &= ~bit;
+
+	if (tile->Flags.Get(TILE_FLAG_BLOCKS_LIGHT))
+		chunk->BlocksLightBitmap[y] |= bit;
+	else
+		chunk->BlocksLightBitmap[y] &= ~bit;
+}
+
+// Adds local tile rect to the chunk's next bake
+inline void
+FixedChunkAddBakeRect(ChunkFixed* chunk, RectI localRect)
+{
+	SAssert(chunk);
+	SAssert(localRect.x >= 0 && localRect.y >= 0);
+	SAssert(localRect.x + localRect.w <= CHUNK_SIZE && localRect.y + localRect.h <= CHUNK_SIZE);
+	chunk->BakeRect = RectIUnion(chunk->BakeRect, localRect);
+	if (chunk->BakeState == ChunkUpdateState::None)
+		chunk->BakeState = ChunkUpdateState::Self;
+}
+
+// Collision row the tile is in, bit n is local x n of the tile's chunk.
+// Rows outside of the map are fully solid.
+inline u32
+FixedChunkGetCollisionRow(TileMapFixed* tilemap, Vec2i tile)
+{
+	ChunkFixed* chunk = FixedChunkGetByTile(tilemap, tile);
+	if (chunk)
+		return chunk->CollisionBitmap[tile.y & CHUNK_SIZE_MASK];
+	else
+		return UINT32_MAX;
+}
+
+// Tiles outside of the map are solid
+inline bool
+FixedChunkIsTileSolid(TileMapFixed* tilemap, Vec2i tile)
+{
+	u32 row = FixedChunkGetCollisionRow(tilemap, tile);
+	return BitGet(row, tile.x & CHUNK_SIZE_MASK);
+}
+
+inline bool
+FixedChunkIsTileBlockingLight(TileMapFixed* tilemap, Vec2i tile)
+{
+	ChunkFixed* chunk = FixedChunkGetByTile(tilemap, tile);
+	if (chunk)
+	{
+		u32 row = chunk->BlocksLightBitmap[tile.y & CHUNK_SIZE_MASK];
+		return BitGet(row, tile.x & CHUNK_SIZE_MASK);
+	}
+	else
+	{
+		return false;
+	}
+}
+
+// *************
+// TileCursor
+// Caches the last resolved chunk so walking neighboring tiles only
+// looks up a chunk when crossing a chunk border.
+
+struct TileCursor
+{
+	TileMapFixed* Tilemap;
+	ChunkFixed* Chunk; // nullptr when ChunkOrigin is outside of the map
+	Vec2i ChunkOrigin;
+};
+
+inline TileCursor
+TileCursorCreate(TileMapFixed* tilemap)
+{
+	SAssert(tilemap);
+	TileCursor cursor;
+	cursor.Tilemap = tilemap;
+	cursor.Chunk = nullptr;
+	cursor.ChunkOrigin = Vec2i_NULL;
+	return cursor;
+}
+
+inline ChunkFixed*
+TileCursorSeek(TileCursor* cursor, Vec2i tile)
+{
+	SAssert(cursor);
+	u32 localX = (u32)tile.x - (u32)cursor->ChunkOrigin.x;
+	u32 localY = (u32)tile.y - (u32)cursor->ChunkOrigin.y;
+	if (localX >= (u32)CHUNK_SIZE || localY >= (u32)CHUNK_SIZE)
+	{
+		cursor->ChunkOrigin.x = tile.x & ~CHUNK_SIZE_MASK;
+		cursor->ChunkOrigin.y = tile.y & ~CHUNK_SIZE_MASK;
+		cursor->Chunk = FixedChunkGetByTile(cursor->Tilemap, tile);
+	}
+	return cursor->Chunk;
+}
+
+inline Tile*
+TileCursorGet(TileCursor* cursor, Vec2i tile)
+{
+	ChunkFixed* chunk = TileCursorSeek(cursor, tile);
+	if (chunk)
+		return &chunk->TileArray[FixedChunkGetLocalTileIdx(tile)];
+	else
+		return nullptr;
+}
+
+inline u32
+TileCursorGetCollisionRow(TileCursor* cursor, Vec2i tile)
+{
+	ChunkFixed* chunk = TileCursorSeek(cursor, tile);
+	if (chunk)
+		return chunk->CollisionBitmap[tile.y & CHUNK_SIZE_MASK];
+	else
+		return UINT32_MAX;
+}
+
+inline bool
+TileCursorIsSolid(TileCursor* cursor, Vec2i tile)
+{
+	u32 row = TileCursorGetCollisionRow(cursor, tile);
+	return BitGet(row, tile.x & CHUNK_SIZE_MASK);
+}
+
+inline bool
+TileCursorIsBlockingLight(TileCursor* cursor, Vec2i tile)
+{
+	ChunkFixed* chunk = TileCursorSeek(cursor, tile);
+	if (chunk)
+	{
+		u32 row = chunk->BlocksLightBitmap[tile.y & CHUNK_SIZE_MASK];
+		return BitGet(row, tile.x & CHUNK_SIZE_MASK);
+	}
+	else
+	{
+		return false;
+	}
+}
+
+// Returns mask of the 8 neighbors of tile, bit i is Vec2i_NEIGHTBORS[i].
+// Set bits are solid or outside of the map.
+inline u8
+TileCursorGetSolidNeighbors(TileCursor* cursor, Vec2i tile)
+{
+	// 3 bits per row, bit 0 is x - 1
+	u32 rows[3];
+	int localX = tile.x & CHUNK_SIZE_MASK;
+	if (localX > 0 && localX < CHUNK_SIZE - 1)
+	{
+		for (int i = 0; i < 3; ++i)
+		{
+			u32 row = TileCursorGetCollisionRow(cursor, { tile.x, tile.y + i - 1 });
+			rows[i] = (row >> (localX - 1)) & 0x7;
+		}
+	}
+	else
+	{
+		// Neighbors cross into another chunk horizontally
+		for (int i = 0; i < 3; ++i)
+		{
+			rows[i] = 0;
+			for (int j = 0; j < 3; ++j)
+			{
+				if (TileCursorIsSolid(cursor, { tile.x + j - 1, tile.y + i - 1 }))
+					rows[i] |= 1u << j;
+			}
+		}
+	}
+
+	u8 mask = 0;
+	for (int i = 0; i < (int)ArrayLength(Vec2i_NEIGHTBORS); ++i)
+	{
+		Vec2i offset = Vec2i_NEIGHTBORS[i];
+		if (BitGet(rows[offset.y + 1], offset.x + 1))
+			mask |= (u8)(1u << i);
+	}
+	return mask;
+}
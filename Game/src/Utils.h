@@ -5,15 +5,74 @@
 #include <wyhash/wyhash.h>
 
 #include <raylib/src/raylib.h>
+#include <raylib/src/raymath.h>
+
+#include "Vector2i.h"
+
+// wyhash's multiply-fold on a single 64 bit value, a lot cheaper than hashing
+// the same 8 bytes through wyhash(). Both operands take the value, multiplying
+// by a constant left aligned pointers with clustered low bits.
+_FORCE_INLINE_ u64
+HashMix64(u64 value)
+{
+	return _wymix(value ^ _wyp[0], value ^ _wyp[1]);
+}
+
+// How HashMapT, HashSetT and HashMapSwiss hash their keys. Types without a
+// specialization are hashed as bytes with wyhash, keys with padding need one.
+template<typename K>
+struct HashTraits
+{
+	_FORCE_INLINE_ static u64 Hash(const K* key)
+	{
+		return wyhash(key, sizeof(K), 0, _wyp);
+	}
+};
+
+template<typename K>
+struct HashTraitsInteger
+{
+	_FORCE_INLINE_ static u64 Hash(const K* key)
+	{
+		return HashMix64((u64)*key);
+	}
+};
+
+template<> struct HashTraits<i8> : HashTraitsInteger<i8> {};
+template<> struct HashTraits<i16> : HashTraitsInteger<i16> {};
+template<> struct HashTraits<i32> : HashTraitsInteger<i32> {};
+template<> struct HashTraits<i64> : HashTraitsInteger<i64> {};
+template<> struct HashTraits<u8> : HashTraitsInteger<u8> {};
+template<> struct HashTraits<u16> : HashTraitsInteger<u16> {};
+template<> struct HashTraits<u32> : HashTraitsInteger<u32> {};
+template<> struct HashTraits<u64> : HashTraitsInteger<u64> {};
 
 template<typename T>
+struct HashTraits<T*>
+{
+	_FORCE_INLINE_ static u64 Hash(T* const* key)
+	{
+		return HashMix64((u64)(uintptr_t)*key);
+	}
+};
+
+template<>
+struct HashTraits<Vector2i>
+{
+	_FORCE_INLINE_ static u64 Hash(const Vector2i* key)
+	{
+		return HashMix64(((u64)(u32)key->x << 32) | (u64)(u32)key->y);
+	}
+};
+
+template<typename K>
 _FORCE_INLINE_ u64
-Hash(T& value)
+Hash(const K* key)
 {
-	return wyhash(value, sizeof(T), 0, _wyp);
+	return HashTraits<K>::Hash(key);
 }
 
-#define HashAndMod(value, capacity) (Hash((value)) & (capacity - 1))
+#define HashAndMod(key, capacity) (Hash((key)) & (capacity - 1))
 
 _FORCE_INLINE_ double GetMicroTime()
 {
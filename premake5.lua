@@ -69,83 +69,99 @@ filter {}
 
 local SrcDir = "Game/src/"
 
-project "Game"
-    kind "ConsoleApp"
-    language "C++"
-    cdialect "C99"
-    cppdialect "C++17"
-    staticruntime "off"
-
-    targetdir("%{wks.location}/bin/" .. outputdir .. "/%{prj.name}")
-    objdir("%{wks.location}/bin-int/" .. outputdir .. "/%{prj.name}")
-
-    files
-    {
-        SrcDir .. "**.cpp",
-        SrcDir .. "**.c",
-        SrcDir .. "**.h",
-        "Game/vendor/bscal-sx/*.cpp",
-        "Game/vendor/bscal-sx/*.h",
-        "Game/vendor/flecs/flecs.c",
-    }
-
-    defines
-    {
-      --  "SCAL_BUILD_DLL"
-    }
-
-    includedirs
-    {
-        "Game/src",
-        "Game/vendor",
-    }
-
-    libdirs
-    {
-        "%{wks.location}/bin/" .. outputdir .. "/raylib/",
-        "Game/vendor/luajit/src"
-    }
+-- GameHeadless builds the same sources with a main that runs the simulation
+-- without a window, see Game/src/Headless.cpp
+-- Bench swaps Main.cpp for the container microbenchmarks in Game/bench
+local function GameProject(name, extraDefines, isBench)
+    project(name)
+        kind "ConsoleApp"
+        language "C++"
+        cdialect "C99"
+        cppdialect "C++17"
+        staticruntime "off"
+
+        targetdir("%{wks.location}/bin/" .. outputdir .. "/%{prj.name}")
+        objdir("%{wks.location}/bin-int/" .. outputdir .. "/%{prj.name}")
+
+        files
+        {
+            SrcDir .. "**.cpp",
+            SrcDir .. "**.c",
+            SrcDir .. "**.h",
+            "Game/vendor/bscal-sx/*.cpp",
+            "Game/vendor/bscal-sx/*.h",
+            "Game/vendor/flecs/flecs.c",
+        }
 
-    links
-    {
-        "raylib",
-        "lua51",
-        "luajit",
-    }
+        if isBench then
+            files { "Game/bench/**.cpp", "Game/bench/**.h" }
+            removefiles { SrcDir .. "Main.cpp" }
+            includedirs { "Game/bench" }
+        end
 
-    -- -Xclang passes to clang compiler regular -Wno doesnt work with clang-cl :)
-    filter "toolset:msc-ClangCL"
-        buildoptions
-        { 
-            "-Wno-c++98-compat-pedantic", "-Wno-old-style-cast", "-Wno-extra-semi-stmt",
-            "-Xclang -Wno-missing-braces", "-Xclang -Wno-missing-field-initializers",
-            "-Wno-error=misleading-indentation", "-Xclang -Wno-unused-variable",
-            "-Wno-error=unused-command-line-argument",
-            "-Xclang -Wno-unused-but-set-variable"
+        defines
+        {
+          --  "SCAL_BUILD_DLL"
         }
+        defines(extraDefines)
 
-    filter "configurations:Debug"
-        defines "SCAL_DEBUG"
-        runtime "Debug"
-        symbols "on"
+        includedirs
+        {
+            "Game/src",
+            "Game/vendor",
+        }
 
-    filter "configurations:Release"
-        defines "SCAL_RELEASE"
-        runtime "Release"
-        optimize "on"
+        libdirs
+        {
+            "%{wks.location}/bin/" .. outputdir .. "/raylib/",
+            "Game/vendor/luajit/src"
+        }
 
-    filter "system:Windows"
-        defines "SCAL_PLATFORM_WINDOWS"
-        systemversion "latest"
-        buildoptions
+        links
         {
-            "-std:c++17", "-W4", "-WX", "-wd4100", "-wd4201", "-wd4127", "-wd4701", "-wd4189",
-            "-Oi", "-GR", "-GR-", "-EHs-c-", "-D_HAS_EXCEPTIONS=0"
+            "raylib",
+            "lua51",
+            "luajit",
         }
-        links { "raylib.lib" }
 
-    filter "system:Unix"
-        defines "SCAL_PLATFORM_LINUX"
-        links { "raylib.so" }
+        -- -Xclang passes to clang compiler regular -Wno doesnt work with clang-cl :)
+        filter "toolset:msc-ClangCL"
+            buildoptions
+            { 
+                "-Wno-c++98-compat-pedantic", "-Wno-old-style-cast", "-Wno-extra-semi-stmt",
+                "-Xclang -Wno-missing-braces", "-Xclang -Wno-missing-field-initializers",
+                "-Wno-error=misleading-indentation", "-Xclang -Wno-unused-variable",
+                "-Wno-error=unused-command-line-argument",
+                "-Xclang -Wno-unused-but-set-variable"
+            }
+
+        filter "configurations:Debug"
+            defines "SCAL_DEBUG"
+            runtime "Debug"
+            symbols "on"
+
+        filter "configurations:Release"
+            defines "SCAL_RELEASE"
+            runtime "Release"
+            optimize "on"
+
+        filter "system:Windows"
+            defines "SCAL_PLATFORM_WINDOWS"
+            systemversion "latest"
+            buildoptions
+            {
+                "-std:c++17", "-W4", "-WX", "-wd4100", "-wd4201", "-wd4127", "-wd4701", "-wd4189",
+                "-Oi", "-GR", "-GR-", "-EHs-c-", "-D_HAS_EXCEPTIONS=0"
+            }
+            links { "raylib.lib" }
+
+        filter "system:Unix"
+            defines "SCAL_PLATFORM_LINUX"
+            links { "raylib.so" }
+
+        filter {}
+end
 
-    filter {}
+GameProject("Game", {})
+GameProject("GameHeadless", { "SCAL_HEADLESS=1" })
+GameProject("Bench", {}, true)